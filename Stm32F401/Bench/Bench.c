@@ -0,0 +1,239 @@
+/*
+ * Bench.c
+ *
+ *  Created on: Sep 9, 2024
+ *      Author: xcite
+ */
+
+#include "Inc/Bench.h"
+#include <stddef.h>
+
+#if BENCH_SINK == BENCH_SINK_LCD
+#include "../HAL/Inc/Lcd.h"
+#elif BENCH_SINK == BENCH_SINK_STDOUT
+#include <stdio.h>
+#endif
+
+/**
+ * @brief Scratch storage for the samples of the case being measured.
+ */
+static uint32_t Bench_Samples[BENCH_SAMPLES];
+
+/**
+ * @brief  Sorts the collected samples in place (insertion sort, n <= BENCH_SAMPLES).
+ * @param  Samples: Sample array.
+ * @param  Count: Number of samples.
+ * @return None
+ */
+static void Bench_Sort(uint32_t *Samples, uint32_t Count)
+    {
+    for (uint32_t i = 1; i < Count; i++)
+	{
+	uint32_t Value = Samples[i];
+	uint32_t j = i;
+
+	while ((j > 0) && (Samples[j - 1] > Value))
+	    {
+	    Samples[j] = Samples[j - 1];
+	    j--;
+	    }
+	Samples[j] = Value;
+	}
+    }
+
+/**
+ * @brief  Runs a case Samples times and records min/median/max.
+ * @param  Case: Case to run.
+ * @param  Overhead: Measurement overhead subtracted from every sample.
+ * @param  Result: Output statistics.
+ * @return None
+ */
+void Bench_Measure(const Bench_Case_t *Case, uint32_t Overhead, Bench_Result_t *Result)
+    {
+    uint32_t Count = (Case->Samples < BENCH_SAMPLES) ? Case->Samples : BENCH_SAMPLES;
+
+    Result->Name = Case->Name;
+    Result->Samples = Count;
+    if (Count == 0)
+	{
+	Result->Min = 0;
+	Result->Median = 0;
+	Result->Max = 0;
+	return;
+	}
+
+    for (uint32_t i = 0; i < Count; i++)
+	{
+	if (Case->Setup != NULL)
+	    {
+	    Case->Setup();
+	    }
+
+	uint32_t Start = BENCH_COUNTER();
+	Case->Run();
+	uint32_t Elapsed = BENCH_COUNTER() - Start;
+
+	Bench_Samples[i] = (Elapsed > Overhead) ? (Elapsed - Overhead) : 0;
+	}
+
+    //---------------------------------------------------------//
+
+    Bench_Sort(Bench_Samples, Count);
+
+    Result->Min = Bench_Samples[0];
+    Result->Median = Bench_Samples[Count / 2];
+    Result->Max = Bench_Samples[Count - 1];
+    }
+
+#if (BENCH_SINK == BENCH_SINK_ITM) || (BENCH_SINK == BENCH_SINK_STDOUT)
+
+/**
+ * @brief  Sends one character to the text sink.
+ * @param  c: Character to send.
+ * @return None
+ */
+static void Bench_PutChar(char c)
+    {
+#if BENCH_SINK == BENCH_SINK_ITM
+    // Drop output when no debugger has enabled stimulus port 0
+    if (!Read(ITM->TCR, ITM_TCR_ITMENA) || !Read(ITM->TER, 0))
+	{
+	return;
+	}
+
+    // Wait for the stimulus port FIFO to accept another byte
+    while (ITM->PORT[0] == 0)
+	{
+	}
+    *(volatile uint8_t *) &ITM->PORT[0] = (uint8_t) c;
+#else
+    putchar(c);
+#endif
+    }
+
+/**
+ * @brief  Sends a string to the text sink.
+ * @param  Text: Null-terminated string.
+ * @return None
+ */
+static void Bench_PutString(const char *Text)
+    {
+    while (*Text)
+	{
+	Bench_PutChar(*Text++);
+	}
+    }
+
+/**
+ * @brief  Sends an unsigned number in decimal to the text sink.
+ * @param  Value: Number to print.
+ * @return None
+ */
+static void Bench_PutNumber(uint32_t Value)
+    {
+    char Digits[10];
+    uint32_t Length = 0;
+
+    do
+	{
+	Digits[Length++] = (char) ('0' + (Value % 10));
+	Value /= 10;
+	}
+    while (Value);
+
+    while (Length)
+	{
+	Bench_PutChar(Digits[--Length]);
+	}
+    }
+
+/**
+ * @brief  Emits results as CSV, preceded by a '#' line describing the build
+ *         so reports from different builds can be compared.
+ * @param  Results: Array of results.
+ * @param  Count: Number of results.
+ * @return None
+ */
+void Bench_Report(const Bench_Result_t *Results, uint32_t Count)
+    {
+    Bench_PutString("# unit=" BENCH_UNIT);
+#if defined(__OPTIMIZE_SIZE__)
+    Bench_PutString(" opt=Os");
+#elif defined(__OPTIMIZE__)
+    Bench_PutString(" opt=O1+");
+#else
+    Bench_PutString(" opt=O0");
+#endif
+    Bench_PutString(" clock=");
+    Bench_PutNumber(CORE_CLOCK_HZ);
+    Bench_PutString(" compiler=" __VERSION__ "\n");
+    Bench_PutString("case,min,median,max,samples\n");
+
+    for (uint32_t i = 0; i < Count; i++)
+	{
+	Bench_PutString(Results[i].Name);
+	Bench_PutChar(',');
+	Bench_PutNumber(Results[i].Min);
+	Bench_PutChar(',');
+	Bench_PutNumber(Results[i].Median);
+	Bench_PutChar(',');
+	Bench_PutNumber(Results[i].Max);
+	Bench_PutChar(',');
+	Bench_PutNumber(Results[i].Samples);
+	Bench_PutChar('\n');
+	}
+    }
+
+#elif BENCH_SINK == BENCH_SINK_LCD
+
+/**
+ * @brief  Shows the median of each case on the LCD, one case at a time.
+ * @param  Results: Array of results.
+ * @param  Count: Number of results.
+ * @return None
+ */
+void Bench_Report(const Bench_Result_t *Results, uint32_t Count)
+    {
+    for (uint32_t i = 0; i < Count; i++)
+	{
+	char Line[LCD_COLS + 1];
+	uint32_t Value = Results[i].Median;
+	uint32_t Position = LCD_COLS;
+
+	// Right-align the median on the second row
+	Line[Position] = '\0';
+	do
+	    {
+	    Line[--Position] = (char) ('0' + (Value % 10));
+	    Value /= 10;
+	    }
+	while (Value && Position);
+	while (Position)
+	    {
+	    Line[--Position] = ' ';
+	    }
+
+	LCD_Clear();
+	LCD_PrintString(Results[i].Name);
+	LCD_SetCursor(1, 0);
+	LCD_PrintString(Line);
+
+	for (volatile uint32_t Delay = 0; Delay < 1000000; Delay++); // Hold each case on screen
+	}
+    }
+
+#else
+
+/**
+ * @brief  Results stay in Bench_Results for the debugger; nothing to emit.
+ * @param  Results: Array of results.
+ * @param  Count: Number of results.
+ * @return None
+ */
+void Bench_Report(const Bench_Result_t *Results, uint32_t Count)
+    {
+    (void) Results;
+    (void) Count;
+    }
+
+#endif
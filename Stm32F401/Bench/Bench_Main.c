@@ -0,0 +1,135 @@
+/*
+ * Bench_Main.c
+ *
+ *  Created on: Sep 9, 2024
+ *      Author: xcite
+ */
+
+/*
+ * Entry point of the "Benchmark" build configuration, which builds
+ * Stm32F401_Drivers_Bench.elf from this folder instead of Src/main.c.
+ *
+ * Host build under the register simulator (times reported in ns):
+ *   gcc -O2 -fshort-enums -DHOST_SIM Bench/Bench_Main.c Bench/Bench.c \
+ *       Mcal/GPIO.c HAL/Lcd.c Sim/HostSim.c -o bench_host
+ */
+
+#include "Inc/Bench.h"
+#include "../HAL/Inc/Lcd.h"
+#include <stddef.h>
+
+/**
+ * @brief Pins used by the GPIO cases (the LCD occupies PA0-PA6).
+ */
+#define BENCH_OUTPUT_PIN PIN_7
+#define BENCH_INPUT_PIN  PIN_8
+
+static void Bench_Empty(void)
+    {
+    }
+
+static void Bench_GpioWrite(void)
+    {
+    Mcal_Gpio_Write(GPIOA, BENCH_OUTPUT_PIN, High);
+    }
+
+static void Bench_GpioToggle(void)
+    {
+    Mcal_Gpio_Toggle(GPIOA, BENCH_OUTPUT_PIN);
+    }
+
+static void Bench_GpioRead(void)
+    {
+    (void) Mcal_Gpio_Read(GPIOA, BENCH_INPUT_PIN);
+    }
+
+static void Bench_GpioInit(void)
+    {
+    Pin_t Pin = {
+	.Pin_Number = BENCH_OUTPUT_PIN,
+	.Functionality = Output,
+	.Output_mode = Push_Pull,
+	.Speed = Low_Speed,
+	.Pulling_State = No_Pulling
+    };
+
+    Mcal_Gpio_Init(GPIOA, &Pin);
+    }
+
+static void Bench_LcdHome(void)
+    {
+    LCD_SetCursor(0, 0);
+    }
+
+static void Bench_LcdPrintString(void)
+    {
+    LCD_PrintString("0123456789ABCDEF");
+    }
+
+/**
+ * @brief Cases in report order; the first one measures the harness overhead.
+ */
+static const Bench_Case_t Bench_Cases[] =
+    {
+	{"Baseline", Bench_Empty, BENCH_SAMPLES, NULL},
+	{"Mcal_Gpio_Write", Bench_GpioWrite, BENCH_SAMPLES, NULL},
+	{"Mcal_Gpio_Toggle", Bench_GpioToggle, BENCH_SAMPLES, NULL},
+	{"Mcal_Gpio_Read", Bench_GpioRead, BENCH_SAMPLES, NULL},
+	{"Mcal_Gpio_Init", Bench_GpioInit, BENCH_SAMPLES, NULL},
+	{"LCD_PrintString", Bench_LcdPrintString, 11, Bench_LcdHome},
+    };
+
+#define BENCH_CASE_COUNT (sizeof(Bench_Cases) / sizeof(Bench_Cases[0]))
+
+Bench_Result_t Bench_Results[BENCH_CASE_COUNT];
+volatile uint32_t Bench_Done;
+
+int main(void)
+    {
+    // Start the DWT cycle counter
+    Set(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA, 1);
+    DWT->CYCCNT = 0;
+    Set(DWT->CTRL, DWT_CTRL_CYCCNTENA, 1);
+
+    Pin_t Input_Pin = {
+	.Pin_Number = BENCH_INPUT_PIN,
+	.Functionality = Input,
+	.Output_mode = Push_Pull,
+	.Speed = Low_Speed,
+	.Pulling_State = Pull_Down
+    };
+    Mcal_Gpio_Init(GPIOA, &Input_Pin);
+    Bench_GpioInit();
+
+    LCD_PinConfig Lcd_Config = {
+	.port = GPIOA,
+	.rs = PIN_0,
+	.rw = PIN_1,
+	.en = PIN_2,
+	.d4 = PIN_3,
+	.d5 = PIN_4,
+	.d6 = PIN_5,
+	.d7 = PIN_6
+    };
+    LCD_Init(&Lcd_Config);
+
+    //---------------------------------------------------------//
+
+    // The baseline is measured raw; its minimum becomes the overhead for the rest
+    Bench_Measure(&Bench_Cases[0], 0, &Bench_Results[0]);
+    for (uint32_t i = 1; i < BENCH_CASE_COUNT; i++)
+	{
+	Bench_Measure(&Bench_Cases[i], Bench_Results[0].Min, &Bench_Results[i]);
+	}
+
+    Bench_Report(Bench_Results, BENCH_CASE_COUNT);
+    Bench_Done = 1;
+
+#ifdef HOST_SIM
+    return 0;
+#else
+    while (1)
+	{
+	}
+#endif
+    }
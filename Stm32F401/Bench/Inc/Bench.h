@@ -0,0 +1,88 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "../../Inc/stm32f401xc.h"
+
+/**
+ * @brief Output sinks for the benchmark report (select with BENCH_SINK).
+ */
+#define BENCH_SINK_RAM    0 /*!< Results kept in Bench_Results only, read them with the debugger */
+#define BENCH_SINK_ITM    1 /*!< CSV report over SWO (ITM stimulus port 0) */
+#define BENCH_SINK_LCD    2 /*!< Median of each case shown on the LCD */
+#define BENCH_SINK_STDOUT 3 /*!< CSV report on stdout (host builds only) */
+
+#ifndef BENCH_SINK
+#ifdef HOST_SIM
+#define BENCH_SINK BENCH_SINK_STDOUT
+#else
+#define BENCH_SINK BENCH_SINK_ITM
+#endif
+#endif
+
+/**
+ * @brief Maximum number of samples taken per benchmark case.
+ */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 101
+#endif
+
+/**
+ * @brief Free-running counter used for timing and its unit.
+ */
+#ifdef HOST_SIM
+#define BENCH_COUNTER() HostSim_Cycles()
+#define BENCH_UNIT      "ns"
+#else
+#define BENCH_COUNTER() (DWT->CYCCNT)
+#define BENCH_UNIT      "cycles"
+#endif
+
+/**
+ * @brief Structure describing one benchmark case.
+ */
+typedef struct
+{
+    const char *Name; /*!< Case name used in the report */
+    void (*Run)(void); /*!< One invocation of the primitive under test */
+    uint16_t Samples; /*!< Number of timed invocations (<= BENCH_SAMPLES) */
+    void (*Setup)(void); /*!< Optional untimed preparation before every invocation */
+} Bench_Case_t;
+
+/**
+ * @brief Structure holding the statistics of one benchmark case.
+ */
+typedef struct
+{
+    const char *Name; /*!< Case name */
+    uint32_t Min; /*!< Fastest invocation, overhead removed */
+    uint32_t Median; /*!< Median invocation, overhead removed */
+    uint32_t Max; /*!< Slowest invocation, overhead removed */
+    uint16_t Samples; /*!< Number of invocations measured */
+} Bench_Result_t;
+
+/**
+ * @brief Results of the last run, one entry per case.
+ */
+extern Bench_Result_t Bench_Results[];
+
+/**
+ * @brief Set to 1 once the report has been emitted (poll it from the debugger).
+ */
+extern volatile uint32_t Bench_Done;
+
+/**
+ * @brief Time a benchmark case. A case with no samples reports all zeros.
+ * @param Case: Case to run.
+ * @param Overhead: Measurement overhead subtracted from every sample.
+ * @param Result: Output statistics.
+ */
+void Bench_Measure(const Bench_Case_t *Case, uint32_t Overhead, Bench_Result_t *Result);
+
+/**
+ * @brief Emit results through the configured sink.
+ * @param Results: Array of results.
+ * @param Count: Number of results.
+ */
+void Bench_Report(const Bench_Result_t *Results, uint32_t Count);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,36 @@
+// Keypad.h
+
+#ifndef KEYPAD_H_
+#define KEYPAD_H_
+
+#include "../../Inc/GPIO.h"
+
+// Keypad dimensions
+#define KEYPAD_ROWS 4
+#define KEYPAD_COLS 4
+
+// Key events
+typedef enum {
+    KEYPAD_KEY_DOWN = 0,
+    KEYPAD_KEY_UP
+} Keypad_Event;
+
+// Called from Keypad_Scan with key = row * KEYPAD_COLS + col
+typedef void (*Keypad_Callback)(uint8_t key, Keypad_Event event);
+
+// Keypad pin configuration: rows are driven (open-drain), columns are read
+// (pull-up). All rows share one port and all columns share one port.
+typedef struct {
+    GPIO_TypeDef* row_port;
+    Pin_index_t rows[KEYPAD_ROWS];
+    GPIO_TypeDef* col_port;
+    Pin_index_t cols[KEYPAD_COLS];
+} Keypad_PinConfig;
+
+// Function prototypes
+void Keypad_Init(Keypad_PinConfig* config, Keypad_Callback callback);
+uint8_t Keypad_Scan(void);
+uint8_t Keypad_IsIdle(void);
+void Keypad_WaitForKey(void);
+
+#endif /* KEYPAD_H_ */
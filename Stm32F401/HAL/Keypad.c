@@ -0,0 +1,159 @@
+/*
+ * Keypad.c
+ *
+ *  Created on: Sep 30, 2024
+ *      Author: xcite
+ */
+#include "Inc/Keypad.h"
+#include "../Inc/EXTI.h"
+#include <stddef.h>
+
+static Keypad_PinConfig* keypad_config;
+static Keypad_Callback keypad_callback;
+
+// Precomputed port masks so a scan is one BSRR write and one IDR read per row
+static uint32_t row_mask;               // all row pins
+static uint32_t row_select[KEYPAD_ROWS]; // BSRR word: release all rows, pull one low
+static uint32_t col_bits[KEYPAD_COLS];   // IDR bit of each column
+static uint16_t col_mask;               // all column pins (EXTI lines)
+
+// Debounced key state and 2-bit vertical counters, one bit per key
+static uint16_t key_state;
+static uint16_t count0 = 0xFFFF;
+static uint16_t count1 = 0xFFFF;
+
+// Set while the keypad sleeps on the column EXTI lines
+static volatile uint8_t keypad_idle;
+
+static void Keypad_Wake(Pin_index_t line, void* context) {
+    (void)line;
+    (void)context;
+
+    // Back to scanning: stop the wake interrupt and release the rows
+    Mcal_Exti_Disable(col_mask);
+    keypad_config->row_port->BSRR = row_mask;
+    keypad_idle = 0;
+}
+
+static uint16_t Keypad_ReadMatrix(void) {
+    uint16_t pressed = 0;
+
+    for (uint8_t row = 0; row < KEYPAD_ROWS; row++) {
+        keypad_config->row_port->BSRR = row_select[row];
+        for (volatile int i = 0; i < 4; i++); // Let the column lines settle
+
+        // Columns are pulled up; a pressed key pulls its column low
+        uint32_t idr = ~keypad_config->col_port->IDR;
+        for (uint8_t col = 0; col < KEYPAD_COLS; col++) {
+            if (idr & col_bits[col]) {
+                pressed |= 1U << (row * KEYPAD_COLS + col);
+            }
+        }
+    }
+
+    keypad_config->row_port->BSRR = row_mask;
+    return pressed;
+}
+
+static void Keypad_Sleep(void) {
+    // Pull every row low so any key press pulls its column low
+    keypad_idle = 1;
+    keypad_config->row_port->BSRR = row_mask << 16;
+    Mcal_Exti_Enable(col_mask);
+
+    // A key pressed before the lines were armed produced no edge
+    if ((keypad_config->col_port->IDR & col_mask) != col_mask) {
+        Keypad_Wake(PIN_0, NULL);
+    }
+}
+
+void Keypad_Init(Keypad_PinConfig* config, Keypad_Callback callback) {
+    keypad_config = config;
+    keypad_callback = callback;
+    row_mask = 0;
+    col_mask = 0;
+
+    // Rows: open-drain outputs, released (high) when idle
+    Pin_t pin_config = {0};
+    pin_config.Output_mode = Open_Drain;
+    pin_config.Speed = Low_Speed;
+    pin_config.Pulling_State = No_Pulling;
+
+    // Claim the rows as inputs first so the port clock is on before the
+    // released level is preset, then switch them to outputs
+    pin_config.Functionality = Input;
+    for (uint8_t row = 0; row < KEYPAD_ROWS; row++) {
+        row_mask |= 1UL << config->rows[row];
+        pin_config.Pin_Number = config->rows[row];
+        Mcal_Gpio_Init(config->row_port, &pin_config);
+    }
+    config->row_port->BSRR = row_mask;
+
+    pin_config.Functionality = Output;
+    for (uint8_t row = 0; row < KEYPAD_ROWS; row++) {
+        row_select[row] = (row_mask & ~(1UL << config->rows[row])) | (1UL << (config->rows[row] + 16));
+        pin_config.Pin_Number = config->rows[row];
+        Mcal_Gpio_Init(config->row_port, &pin_config);
+    }
+
+    // Columns: inputs with pull-up, each doubling as a falling-edge wake line
+    pin_config.Functionality = Input;
+    pin_config.Output_mode = Push_Pull;
+    pin_config.Pulling_State = Pull_Up;
+
+    for (uint8_t col = 0; col < KEYPAD_COLS; col++) {
+        col_bits[col] = 1UL << config->cols[col];
+        col_mask |= (uint16_t)col_bits[col];
+        pin_config.Pin_Number = config->cols[col];
+        Mcal_Gpio_Init(config->col_port, &pin_config);
+        Mcal_Exti_Init(config->col_port, config->cols[col], Exti_Falling, Keypad_Wake, NULL);
+    }
+
+    key_state = 0;
+    count0 = 0xFFFF;
+    count1 = 0xFFFF;
+    keypad_idle = 0;
+}
+
+uint8_t Keypad_Scan(void) {
+    if (keypad_idle) {
+        return 0;
+    }
+
+    // Vertical-counter debounce: a key changes state after 4 equal samples
+    uint16_t changed = key_state ^ Keypad_ReadMatrix();
+    count0 = ~(count0 & changed);
+    count1 = count0 ^ (count1 & changed);
+    changed &= count0 & count1;
+    key_state ^= changed;
+
+    while (changed) {
+        uint8_t key = (uint8_t)__builtin_ctz(changed);
+        changed &= changed - 1;
+        if (keypad_callback != NULL) {
+            keypad_callback(key, (key_state & (1U << key)) ? KEYPAD_KEY_DOWN : KEYPAD_KEY_UP);
+        }
+    }
+
+    // Nothing held and no change in progress: arm the column wake lines
+    if (key_state == 0 && count0 == 0xFFFF && count1 == 0xFFFF) {
+        Keypad_Sleep();
+    }
+    return !keypad_idle;
+}
+
+uint8_t Keypad_IsIdle(void) {
+    return keypad_idle;
+}
+
+void Keypad_WaitForKey(void) {
+    // With PRIMASK set a pending wake still ends WFI, so a key press between
+    // the check and the WFI cannot be slept through
+    __asm volatile("cpsid i" ::: "memory");
+    while (keypad_idle) {
+        __asm volatile("wfi");
+        __asm volatile("cpsie i" ::: "memory");
+        __asm volatile("cpsid i" ::: "memory");
+    }
+    __asm volatile("cpsie i" ::: "memory");
+}
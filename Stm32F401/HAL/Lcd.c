@@ -5,6 +5,7 @@
  *      Author: xcite
  */
 #include "Inc/Lcd.h"
+#include "../Inc/Trace.h"
 #include <stddef.h>
 
 static LCD_PinConfig* lcd_config;
@@ -28,21 +29,27 @@ static void LCD_Write8Bits(uint8_t data) {
 }
 
 void LCD_SendCommand(uint8_t cmd) {
+    TRACE_ENTER(TRACE_ID_LCD_SEND_COMMAND, cmd);
     Mcal_Gpio_Write(lcd_config->port, lcd_config->rs, Low);
     Mcal_Gpio_Write(lcd_config->port, lcd_config->rw, Low);
     LCD_Write8Bits(cmd);
+    TRACE_EXIT(TRACE_ID_LCD_SEND_COMMAND, cmd);
 }
 
 void LCD_SendData(uint8_t data) {
+    TRACE_ENTER(TRACE_ID_LCD_SEND_DATA, data);
     Mcal_Gpio_Write(lcd_config->port, lcd_config->rs, High);
     Mcal_Gpio_Write(lcd_config->port, lcd_config->rw, Low);
     LCD_Write8Bits(data);
+    TRACE_EXIT(TRACE_ID_LCD_SEND_DATA, data);
 }
 
 void LCD_Init(LCD_PinConfig* config) {
+    TRACE_ENTER(TRACE_ID_LCD_INIT, (uintptr_t)config->port);
     lcd_config = config;
 
     // Initialize GPIO pins
+    TRACE_MARK(TRACE_ID_LCD_INIT_PHASE, 1);
     Pin_t pin_config = {0};
     pin_config.Functionality = Output;
     pin_config.Output_mode = Push_Pull;
@@ -71,8 +78,10 @@ void LCD_Init(LCD_PinConfig* config) {
     Mcal_Gpio_Init(config->port, &pin_config);
 
     // LCD initialization sequence
+    TRACE_MARK(TRACE_ID_LCD_INIT_PHASE, 2);
     for(volatile int i = 0; i < 50000; i++); // Wait for >40ms after power on
 
+    TRACE_MARK(TRACE_ID_LCD_INIT_PHASE, 3);
     LCD_Write4Bits(0x03);
     for(volatile int i = 0; i < 5000; i++); // Wait for >4.1ms
 
@@ -82,20 +91,26 @@ void LCD_Init(LCD_PinConfig* config) {
     LCD_Write4Bits(0x03);
     LCD_Write4Bits(0x02); // Set 4-bit mode
 
+    TRACE_MARK(TRACE_ID_LCD_INIT_PHASE, 4);
     LCD_SendCommand(0x28); // Function set: 4-bit mode, 2 lines, 5x8 font
     LCD_SendCommand(0x0C); // Display control: Display on, cursor off, blink off
     LCD_SendCommand(0x06); // Entry mode set: Increment cursor, no display shift
     LCD_Clear();
+    TRACE_EXIT(TRACE_ID_LCD_INIT, (uintptr_t)config->port);
 }
 
 void LCD_Clear(void) {
+    TRACE_ENTER(TRACE_ID_LCD_CLEAR, 0);
     LCD_SendCommand(LCD_CLEAR_DISPLAY);
     for(volatile int i = 0; i < 2000; i++); // Wait for >1.52ms
+    TRACE_EXIT(TRACE_ID_LCD_CLEAR, 0);
 }
 
 void LCD_SetCursor(uint8_t row, uint8_t col) {
     uint8_t row_offsets[] = {0x00, 0x40};
+    TRACE_ENTER(TRACE_ID_LCD_SET_CURSOR, (row << 8) | col);
     LCD_SendCommand(LCD_SET_DDRAM_ADDR | (col + row_offsets[row]));
+    TRACE_EXIT(TRACE_ID_LCD_SET_CURSOR, (row << 8) | col);
 }
 
 void LCD_PrintChar(char c) {
@@ -103,9 +118,12 @@ void LCD_PrintChar(char c) {
 }
 
 void LCD_PrintString(const char* str) {
-    while(*str) {
-        LCD_PrintChar(*str++);
+    TRACE_ENTER(TRACE_ID_LCD_PRINT_STRING, (uintptr_t)str);
+    const char* p = str;
+    while(*p) {
+        LCD_PrintChar(*p++);
     }
+    TRACE_EXIT(TRACE_ID_LCD_PRINT_STRING, (uintptr_t)str);
 }
 
 
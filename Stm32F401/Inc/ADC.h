@@ -0,0 +1,130 @@
+#ifndef ADC_H_
+#define ADC_H_
+
+#include "GPIO.h"
+
+/**
+ * @brief Maximum number of channels in a scan sequence.
+ */
+#define ADC_MAX_CHANNELS 16
+
+/**
+ * @brief Bits of an Adc_Channel_t holding the hardware channel number; the
+ * flag above them tells VBAT apart from the temperature sensor on channel 18.
+ */
+#define ADC_CHANNEL_NUMBER_MASK 0x1F
+#define ADC_CHANNEL_VBAT_FLAG   0x20
+
+/**
+ * @brief ADC1 input channels. Channels 0-15 are routed to pins
+ * (PA0-PA7, PB0-PB1, PC0-PC5). On the F401, VREFINT is channel 17 and the
+ * temperature sensor shares channel 18 with VBAT: VBATE selects VBAT, so
+ * the two cannot be in the same sequence and Mcal_Adc_Init clears VBATE
+ * whenever the temperature sensor is used.
+ */
+typedef enum
+{
+    Adc_Channel_0 = 0, /*!< PA0 */
+    Adc_Channel_1, /*!< PA1 */
+    Adc_Channel_2, /*!< PA2 */
+    Adc_Channel_3, /*!< PA3 */
+    Adc_Channel_4, /*!< PA4 */
+    Adc_Channel_5, /*!< PA5 */
+    Adc_Channel_6, /*!< PA6 */
+    Adc_Channel_7, /*!< PA7 */
+    Adc_Channel_8, /*!< PB0 */
+    Adc_Channel_9, /*!< PB1 */
+    Adc_Channel_10, /*!< PC0 */
+    Adc_Channel_11, /*!< PC1 */
+    Adc_Channel_12, /*!< PC2 */
+    Adc_Channel_13, /*!< PC3 */
+    Adc_Channel_14, /*!< PC4 */
+    Adc_Channel_15, /*!< PC5 */
+    Adc_Channel_Vrefint = 17, /*!< Internal reference voltage (ADC1_IN17) */
+    Adc_Channel_Temperature = 18, /*!< Internal temperature sensor (ADC1_IN18, VBATE off) */
+    Adc_Channel_Vbat = ADC_CHANNEL_VBAT_FLAG | 18 /*!< VBAT / 4 (ADC1_IN18, VBATE on) */
+} Adc_Channel_t;
+
+/**
+ * @brief Enumeration for ADC sampling times, in ADC clock cycles.
+ * A conversion takes the sampling time plus 12 cycles at 12-bit resolution.
+ */
+typedef enum
+{
+    Adc_Sample_3 = 0, /*!< 3 cycles */
+    Adc_Sample_15, /*!< 15 cycles */
+    Adc_Sample_28, /*!< 28 cycles */
+    Adc_Sample_56, /*!< 56 cycles */
+    Adc_Sample_84, /*!< 84 cycles */
+    Adc_Sample_112, /*!< 112 cycles */
+    Adc_Sample_144, /*!< 144 cycles */
+    Adc_Sample_480 /*!< 480 cycles */
+} Adc_Sample_Time_t;
+
+/**
+ * @brief Enumeration for the ADC clock prescaler (from PCLK2, max 36 MHz ADC clock).
+ */
+typedef enum
+{
+    Adc_Prescaler_2 = 0, /*!< PCLK2 / 2 */
+    Adc_Prescaler_4, /*!< PCLK2 / 4 */
+    Adc_Prescaler_6, /*!< PCLK2 / 6 */
+    Adc_Prescaler_8 /*!< PCLK2 / 8 */
+} Adc_Prescaler_t;
+
+/**
+ * @brief Block callback, called from the DMA interrupt each time half of the
+ * buffer has been filled.
+ * @param Averages: Mean of every channel over the block, in sequence order.
+ * @param Samples: The raw block (Frames frames of Channel_Count samples).
+ * @param Frames: Number of frames in the block.
+ */
+typedef void (*Adc_Callback_t)(const uint16_t *Averages, const uint16_t *Samples, uint16_t Frames);
+
+/**
+ * @brief Structure for configuring a continuous scan acquisition.
+ */
+typedef struct
+{
+    const Adc_Channel_t *Channels; /*!< Scan sequence */
+    uint8_t Channel_Count; /*!< Number of channels in the sequence (1 to 16) */
+    Adc_Sample_Time_t Sample_Time; /*!< Sampling time applied to every channel */
+    Adc_Prescaler_t Prescaler; /*!< ADC clock prescaler */
+    uint16_t *Buffer; /*!< Circular buffer of Frames * Channel_Count samples */
+    uint16_t Frames; /*!< Frames in the buffer (even, Frames * Channel_Count <= 65535); half are averaged per callback */
+    Adc_Callback_t Callback; /*!< Block callback */
+} Adc_Config_t;
+
+/**
+ * @brief Configure ADC1, its analog pins and the DMA stream for a scan sequence.
+ * @param Config: Acquisition configuration (must stay valid while running).
+ * @return 1 on success, 0 if the configuration is invalid: Channel_Count not
+ * 1 to 16, a channel the F401 does not have (16, or above 18 except VBAT),
+ * Frames zero or odd, Frames * Channel_Count above 65535 (the DMA transfer
+ * limit), or both the temperature sensor and VBAT in the sequence.
+ */
+uint8_t Mcal_Adc_Init(const Adc_Config_t *Config);
+
+/**
+ * @brief Start continuous conversions into the circular buffer.
+ */
+void Mcal_Adc_Start(void);
+
+/**
+ * @brief Stop conversions and the DMA stream.
+ */
+void Mcal_Adc_Stop(void);
+
+/**
+ * @brief Number of overruns recovered from since Mcal_Adc_Init.
+ * @return Overrun count.
+ */
+uint32_t Mcal_Adc_Overruns(void);
+
+/**
+ * @brief Number of DMA transfer errors recovered from since Mcal_Adc_Init.
+ * @return DMA error count.
+ */
+uint32_t Mcal_Adc_DmaErrors(void);
+
+#endif /* ADC_H_ */
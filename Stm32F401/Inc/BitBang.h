@@ -0,0 +1,213 @@
+#ifndef BITBANG_H_
+#define BITBANG_H_
+
+#include "GPIO.h"
+
+/**
+ * @brief Convert a duration in nanoseconds to core clock cycles (rounded up).
+ */
+#define BITBANG_NS_TO_CYCLES(Ns) ((uint32_t) (((uint64_t) (Ns) * CORE_CLOCK_HZ + 999999999ULL) / 1000000000ULL))
+
+/**
+ * @brief Convert a duration in microseconds to core clock cycles.
+ */
+#define BITBANG_US_TO_CYCLES(Us) ((uint32_t) ((uint64_t) (Us) * CORE_CLOCK_HZ / 1000000ULL))
+
+/**
+ * @brief WS2812 bit timing in nanoseconds (datasheet nominal values).
+ * @note  T0H is only 6-7 cycles at the 16 MHz reset clock, too few for the bit
+ *        windows to stay within tolerance; Mcal_BitBang_Ws2812_Send refuses to
+ *        run below BITBANG_WS2812_MIN_CLOCK_HZ.
+ */
+#define BITBANG_WS2812_MIN_CLOCK_HZ 48000000UL
+#define BITBANG_WS2812_T0H_NS    400
+#define BITBANG_WS2812_T1H_NS    800
+#define BITBANG_WS2812_PERIOD_NS 1250
+#define BITBANG_WS2812_RESET_US  300
+
+/**
+ * @brief 1-Wire standard-speed timing in microseconds.
+ */
+#define BITBANG_ONEWIRE_RESET_US     480 /*!< Reset pulse low time */
+#define BITBANG_ONEWIRE_PRESENCE_US  70 /*!< Reset release to presence sample */
+#define BITBANG_ONEWIRE_SLOT_US      70 /*!< Full time slot including recovery */
+#define BITBANG_ONEWIRE_WRITE1_US    6 /*!< Low time of a write-1 slot */
+#define BITBANG_ONEWIRE_WRITE0_US    60 /*!< Low time of a write-0 slot */
+#define BITBANG_ONEWIRE_SAMPLE_US    15 /*!< Slot start to read sample */
+
+/**
+ * @brief Structure describing a bit-banged pin.
+ * The BSRR words are precomputed so each edge costs a single store.
+ */
+typedef struct
+{
+    GPIO_TypeDef *Port; /*!< GPIO port */
+    uint32_t Set; /*!< BSRR word driving the pin high (or releasing it for open-drain) */
+    uint32_t Reset; /*!< BSRR word driving the pin low */
+    uint32_t Mask; /*!< IDR mask of the pin */
+} BitBang_Pin_t;
+
+/**
+ * @brief Structure describing a software SPI bus (mode 0, MSB first).
+ */
+typedef struct
+{
+    BitBang_Pin_t Sck; /*!< Clock output */
+    BitBang_Pin_t Mosi; /*!< Data output */
+    BitBang_Pin_t Miso; /*!< Data input, see Mcal_BitBang_Input_Init */
+    uint32_t Half_Period; /*!< Half SCK period in cycles */
+} BitBang_Spi_t;
+
+/**
+ * @brief Structure describing a software I2C bus (both lines open-drain).
+ */
+typedef struct
+{
+    BitBang_Pin_t Scl; /*!< Clock line */
+    BitBang_Pin_t Sda; /*!< Data line */
+    uint32_t Half_Period; /*!< Half SCL period in cycles */
+    uint32_t Stretch_Timeout; /*!< Maximum clock stretching in cycles */
+} BitBang_I2c_t;
+
+/**
+ * @brief  Drive a bit-banged pin high (release it if open-drain).
+ * @param  Pin: Pin descriptor.
+ */
+static inline void BitBang_High(const BitBang_Pin_t *Pin)
+    {
+    Pin->Port->BSRR = Pin->Set;
+    }
+
+/**
+ * @brief  Drive a bit-banged pin low.
+ * @param  Pin: Pin descriptor.
+ */
+static inline void BitBang_Low(const BitBang_Pin_t *Pin)
+    {
+    Pin->Port->BSRR = Pin->Reset;
+    }
+
+/**
+ * @brief  Sample a bit-banged pin.
+ * @param  Pin: Pin descriptor.
+ * @return Non-zero if the pin is high.
+ */
+static inline uint32_t BitBang_Read(const BitBang_Pin_t *Pin)
+    {
+    return Pin->Port->IDR & Pin->Mask;
+    }
+
+/**
+ * @brief  Busy-wait until Cycles have elapsed since Start (wrap-safe).
+ * @param  Start: DWT->CYCCNT value the interval is measured from.
+ * @param  Cycles: Interval length in cycles.
+ */
+static inline void BitBang_WaitFrom(uint32_t Start, uint32_t Cycles)
+    {
+    while ((DWT->CYCCNT - Start) < Cycles)
+	{
+	}
+    }
+
+/**
+ * @brief  Busy-wait for a number of cycles.
+ * @param  Cycles: Delay in cycles.
+ */
+static inline void BitBang_Delay(uint32_t Cycles)
+    {
+    BitBang_WaitFrom(DWT->CYCCNT, Cycles);
+    }
+
+/**
+ * @brief Start the DWT cycle counter used by all bit-bang timing.
+ */
+void Mcal_BitBang_Init(void);
+
+/**
+ * @brief Configure a pin for bit-banging and fill its descriptor. Open-drain pins
+ * start released (high), push-pull pins start low.
+ * @param Pin: Descriptor to fill.
+ * @param GPIOx: Pointer to the GPIO port.
+ * @param Pin_Number: Pin number.
+ * @param Output_mode: Push_Pull for WS2812/SPI, Open_Drain for 1-Wire/I2C.
+ */
+void Mcal_BitBang_Pin_Init(BitBang_Pin_t *Pin, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Output_mode_t Output_mode);
+
+/**
+ * @brief Configure a pin as a bit-banged input (e.g. software SPI MISO).
+ * @param Pin: Descriptor to fill.
+ * @param GPIOx: Pointer to the GPIO port.
+ * @param Pin_Number: Pin number.
+ * @param Pulling_State: Pull-up/pull-down configuration.
+ */
+void Mcal_BitBang_Input_Init(BitBang_Pin_t *Pin, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Pulling_t Pulling_State);
+
+/**
+ * @brief Send GRB pixel data to a WS2812 strip and latch it.
+ * @param Pin: Data pin (push-pull).
+ * @param Data: Pixel bytes in G, R, B order.
+ * @param Length: Number of bytes (3 per pixel).
+ * @return 1 on success, 0 if CORE_CLOCK_HZ is below BITBANG_WS2812_MIN_CLOCK_HZ.
+ */
+uint8_t Mcal_BitBang_Ws2812_Send(const BitBang_Pin_t *Pin, const uint8_t *Data, uint32_t Length);
+
+/**
+ * @brief Issue a 1-Wire reset and detect a presence pulse.
+ * @param Pin: Bus pin (open-drain).
+ * @return 1 if at least one device answered, 0 otherwise.
+ */
+uint8_t Mcal_BitBang_OneWire_Reset(const BitBang_Pin_t *Pin);
+
+/**
+ * @brief Write one byte on the 1-Wire bus, LSB first.
+ * @param Pin: Bus pin (open-drain).
+ * @param Data: Byte to write.
+ */
+void Mcal_BitBang_OneWire_WriteByte(const BitBang_Pin_t *Pin, uint8_t Data);
+
+/**
+ * @brief Read one byte from the 1-Wire bus, LSB first.
+ * @param Pin: Bus pin (open-drain).
+ * @return Byte read.
+ */
+uint8_t Mcal_BitBang_OneWire_ReadByte(const BitBang_Pin_t *Pin);
+
+/**
+ * @brief Exchange one byte on a software SPI bus.
+ * @param Bus: SPI bus descriptor.
+ * @param Data: Byte to send.
+ * @return Byte received.
+ */
+uint8_t Mcal_BitBang_Spi_Transfer(const BitBang_Spi_t *Bus, uint8_t Data);
+
+/**
+ * @brief Generate an I2C start (or repeated start) condition.
+ * @param Bus: I2C bus descriptor.
+ */
+void Mcal_BitBang_I2c_Start(const BitBang_I2c_t *Bus);
+
+/**
+ * @brief Generate an I2C stop condition.
+ * @param Bus: I2C bus descriptor.
+ */
+void Mcal_BitBang_I2c_Stop(const BitBang_I2c_t *Bus);
+
+/**
+ * @brief Write one byte on the I2C bus.
+ * @param Bus: I2C bus descriptor.
+ * @param Data: Byte to write.
+ * @return 1 if the target acknowledged, 0 on NACK or clock-stretch timeout.
+ */
+uint8_t Mcal_BitBang_I2c_WriteByte(const BitBang_I2c_t *Bus, uint8_t Data);
+
+/**
+ * @brief Read one byte from the I2C bus.
+ * @param Bus: I2C bus descriptor.
+ * @param Ack: 1 to acknowledge the byte, 0 to NACK the last byte.
+ * @return Byte read.
+ */
+uint8_t Mcal_BitBang_I2c_ReadByte(const BitBang_I2c_t *Bus, uint8_t Ack);
+
+#endif /* BITBANG_H_ */
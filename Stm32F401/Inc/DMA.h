@@ -0,0 +1,103 @@
+#ifndef DMA_H_
+#define DMA_H_
+
+#include "stm32f401xc.h"
+
+/**
+ * @brief Enumeration for DMA transfer directions.
+ */
+typedef enum
+{
+    Dma_Peripheral_To_Memory = 0, /*!< Peripheral to memory */
+    Dma_Memory_To_Peripheral, /*!< Memory to peripheral */
+    Dma_Memory_To_Memory /*!< Memory to memory (DMA2 only) */
+} Dma_Direction_t;
+
+/**
+ * @brief Enumeration for DMA data sizes.
+ */
+typedef enum
+{
+    Dma_Byte = 0, /*!< 8-bit transfers */
+    Dma_Half_Word, /*!< 16-bit transfers */
+    Dma_Word /*!< 32-bit transfers */
+} Dma_Size_t;
+
+/**
+ * @brief Enumeration for DMA stream priorities.
+ */
+typedef enum
+{
+    Dma_Priority_Low = 0, /*!< Low priority */
+    Dma_Priority_Medium, /*!< Medium priority */
+    Dma_Priority_High, /*!< High priority */
+    Dma_Priority_Very_High /*!< Very high priority */
+} Dma_Priority_t;
+
+/**
+ * @brief Enumeration for events reported to a stream callback.
+ */
+typedef enum
+{
+    Dma_Half_Transfer = 0, /*!< First half of the buffer is complete */
+    Dma_Transfer_Complete, /*!< Whole buffer is complete */
+    Dma_Transfer_Error /*!< Transfer or direct-mode error, stream disabled */
+} Dma_Event_t;
+
+/**
+ * @brief Stream event callback, called from the stream's interrupt handler.
+ */
+typedef void (*Dma_Callback_t)(Dma_Event_t Event, void *Context);
+
+/**
+ * @brief Structure for configuring a DMA stream.
+ */
+typedef struct
+{
+    DMA_TypeDef *Controller; /*!< DMA1 or DMA2 */
+    uint8_t Stream; /*!< Stream number (0 to 7) */
+    uint8_t Channel; /*!< Request channel (0 to 7), see the reference manual mapping */
+    Dma_Direction_t Direction; /*!< Transfer direction */
+    Dma_Size_t Peripheral_Size; /*!< Peripheral data size */
+    Dma_Size_t Memory_Size; /*!< Memory data size */
+    uint8_t Memory_Increment; /*!< 1 to increment the memory address */
+    uint8_t Circular; /*!< 1 for circular mode */
+    Dma_Priority_t Priority; /*!< Stream priority */
+    Dma_Callback_t Callback; /*!< Event callback, NULL for none */
+    void *Context; /*!< Passed to Callback */
+} Dma_Config_t;
+
+/**
+ * @brief Configure a DMA stream and enable its interrupt.
+ * The stream is left disabled; start it with Mcal_Dma_Start.
+ * @param Config: Stream configuration.
+ */
+void Mcal_Dma_Init(const Dma_Config_t *Config);
+
+/**
+ * @brief Start a transfer on a configured stream.
+ * @param Controller: DMA1 or DMA2.
+ * @param Stream: Stream number.
+ * @param Peripheral: Peripheral register address.
+ * @param Memory: Memory buffer address.
+ * @param Count: Number of data items to transfer.
+ */
+void Mcal_Dma_Start(DMA_TypeDef *Controller, uint8_t Stream, volatile void *Peripheral,
+	void *Memory, uint16_t Count);
+
+/**
+ * @brief Stop a stream and wait until it is disabled.
+ * @param Controller: DMA1 or DMA2.
+ * @param Stream: Stream number.
+ */
+void Mcal_Dma_Stop(DMA_TypeDef *Controller, uint8_t Stream);
+
+/**
+ * @brief Number of data items left in the current transfer.
+ * @param Controller: DMA1 or DMA2.
+ * @param Stream: Stream number.
+ * @return Remaining item count (NDTR).
+ */
+uint16_t Mcal_Dma_Remaining(DMA_TypeDef *Controller, uint8_t Stream);
+
+#endif /* DMA_H_ */
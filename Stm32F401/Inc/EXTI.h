@@ -0,0 +1,45 @@
+#ifndef EXTI_H_
+#define EXTI_H_
+
+#include "GPIO.h"
+
+/**
+ * @brief Enumeration for EXTI trigger edges.
+ */
+typedef enum
+{
+    Exti_Rising = 1, /*!< Rising edge */
+    Exti_Falling, /*!< Falling edge */
+    Exti_Both /*!< Both edges */
+} Exti_Edge_t;
+
+/**
+ * @brief Line callback, called from the EXTI interrupt with the pending flag already cleared.
+ */
+typedef void (*Exti_Callback_t)(Pin_index_t Line, void *Context);
+
+/**
+ * @brief Route a GPIO pin to its EXTI line and register a callback.
+ * The line is left masked; unmask it with Mcal_Exti_Enable.
+ * @param GPIOx: Pointer to the GPIO port.
+ * @param Pin_Number: Pin number (selects EXTI line 0 to 15).
+ * @param Edge: Trigger edge(s).
+ * @param Callback: Function called on each trigger.
+ * @param Context: Passed to Callback.
+ */
+void Mcal_Exti_Init(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number, Exti_Edge_t Edge,
+	Exti_Callback_t Callback, void *Context);
+
+/**
+ * @brief Clear any stale trigger and unmask a set of lines.
+ * @param Lines: Bitmask of EXTI lines (bit n = line n).
+ */
+void Mcal_Exti_Enable(uint16_t Lines);
+
+/**
+ * @brief Mask a set of lines.
+ * @param Lines: Bitmask of EXTI lines (bit n = line n).
+ */
+void Mcal_Exti_Disable(uint16_t Lines);
+
+#endif /* EXTI_H_ */
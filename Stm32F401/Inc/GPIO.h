@@ -3,6 +3,17 @@
 
 #include "stm32f401xc.h"
 
+/**
+ * @brief Size of the GPIO port table (ports A-E and H; F and G do not exist on the F401).
+ */
+#define GPIO_PORT_COUNT 8
+
+/**
+ * @brief Index of a port in the port table. Ports are 1 KB apart from GPIOA,
+ * so the index is also the port's AHB1ENR bit and its SYSCFG EXTICR code.
+ */
+#define GPIO_PORT_INDEX(GPIOx) ((uint32_t) (((uintptr_t) (GPIOx) - (uintptr_t) GPIOA) >> 10))
+
 /**
  * @brief Enumeration for GPIO pin configuration modes.
  * This enum defines the possible modes for GPIO pins.
@@ -93,17 +104,28 @@ typedef struct
     Pin_Output_mode_t Output_mode; /*!< Output type (Push_Pull, Open_Drain) */
     Pin_Logic_Speed_t Speed; /*!< Output speed (Low_Speed, Medium_Speed, High_Speed, Very_High_Speed) */
     Pin_Pulling_t Pulling_State; /*!< Pull-up/pull-down configuration (No_Pulling, Pull_Up, Pull_Down) */
+    uint8_t Alternate_Function; /*!< Alternate function number AF0-AF15 (used when Functionality is Alternative) */
 } Pin_t;
 
 /**
- * @brief Initialize GPIO pin.
+ * @brief Initialize GPIO pin. The pin is claimed and the port clock is
+ * enabled when the port gets its first claimed pin.
  * @param GPIOx: Pointer to the GPIO port.
  * @param Pin: Pointer to the Pin_t structure defining the pin configuration.
  */
 void Mcal_Gpio_Init(GPIO_TypeDef *GPIOx, Pin_t *Pin);
 
 /**
- * @brief Deinitialize GPIO port.
+ * @brief Release a pin claimed by Mcal_Gpio_Init and return it to analog mode.
+ * The port clock is gated off when its last claimed pin is released.
+ * @param GPIOx: Pointer to the GPIO port.
+ * @param Pin_Number: Pin number to release.
+ */
+void Mcal_Gpio_Release(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number);
+
+/**
+ * @brief Deinitialize GPIO port: reset its registers, release all of its pins
+ * and gate its clock off.
  * @param GPIOx: Pointer to the GPIO port.
  */
 void Mcal_Gpio_Deinit(GPIO_TypeDef *GPIOx);
@@ -0,0 +1,111 @@
+#ifndef PWM_H_
+#define PWM_H_
+
+#include "TIM.h"
+
+/**
+ * @brief Full-scale duty cycle (duty is given in hundredths of a percent).
+ */
+#define PWM_DUTY_MAX 10000U
+
+/**
+ * @brief Enumeration for counter alignment.
+ */
+typedef enum
+{
+    Pwm_Edge_Aligned = 0, /*!< Counter counts up, edges move with the duty */
+    Pwm_Center_Aligned /*!< Counter counts up and down, pulses centred on the period */
+} Pwm_Align_t;
+
+/**
+ * @brief Enumeration for output polarity.
+ */
+typedef enum
+{
+    Pwm_Active_High = 0, /*!< Output high during the duty time */
+    Pwm_Active_Low /*!< Output low during the duty time */
+} Pwm_Polarity_t;
+
+/**
+ * @brief Configure a timer as a PWM time base. All channels of a timer share
+ * the frequency; the prescaler is chosen to give the finest duty resolution.
+ * @param Timer: Timer.
+ * @param Frequency: PWM frequency in Hz.
+ * @param Align: Counter alignment.
+ * @return 1 on success, 0 if the frequency cannot be reached.
+ */
+uint8_t Mcal_Pwm_Init(Tim_Id_t Timer, uint32_t Frequency, Pwm_Align_t Align);
+
+/**
+ * @brief Enable PWM mode 1 on a channel, with preloaded compare register.
+ * The channel pin must be connected with Mcal_Tim_Pin_Init. Channels the
+ * timer does not implement are ignored.
+ * @param Timer: Timer.
+ * @param Channel: Channel.
+ * @param Polarity: Output polarity.
+ */
+void Mcal_Pwm_Channel_Init(Tim_Id_t Timer, Tim_Channel_t Channel, Pwm_Polarity_t Polarity);
+
+/**
+ * @brief Start the counter (and the main output of TIM1).
+ * @param Timer: Timer.
+ */
+void Mcal_Pwm_Start(Tim_Id_t Timer);
+
+/**
+ * @brief Stop the counter; outputs hold their current level.
+ * @param Timer: Timer.
+ */
+void Mcal_Pwm_Stop(Tim_Id_t Timer);
+
+/**
+ * @brief Set the duty cycle of a channel. The new value takes effect at the
+ * next update event, so a running period is never cut short. Channels the
+ * timer does not implement are ignored.
+ * @param Timer: Timer.
+ * @param Channel: Channel.
+ * @param Duty: Duty cycle, 0 to PWM_DUTY_MAX.
+ */
+void Mcal_Pwm_SetDuty(Tim_Id_t Timer, Tim_Channel_t Channel, uint16_t Duty);
+
+/**
+ * @brief Change the frequency of a running timer, keeping every channel's duty.
+ * Period and compare values switch together at the next update event.
+ * @param Timer: Timer.
+ * @param Frequency: PWM frequency in Hz.
+ * @return 1 on success, 0 if the frequency cannot be reached.
+ */
+uint8_t Mcal_Pwm_SetFrequency(Tim_Id_t Timer, uint32_t Frequency);
+
+/**
+ * @brief Number of compare steps in one period, the scale Mcal_Pwm_SetDuty maps
+ * duty onto: ARR + 1 edge-aligned, ARR center-aligned. A compare value of
+ * Mcal_Pwm_Steps is 100% duty edge-aligned; center-aligned, 100% needs
+ * Mcal_Pwm_Steps + 1.
+ * @param Timer: Timer.
+ * @return Period in compare steps.
+ */
+uint32_t Mcal_Pwm_Steps(Tim_Id_t Timer);
+
+/**
+ * @brief Stream raw compare values into a channel, one per period, using the
+ * timer's update DMA request.
+ * @param Timer: Timer (TIM1 to TIM5).
+ * @param Channel: Channel.
+ * @param Compares: Compare values (0 to Mcal_Pwm_Steps, + 1 for 100% center-aligned): uint32_t for TIM2/TIM5, uint16_t otherwise.
+ * @param Count: Number of values.
+ * @param Circular: 1 to replay the buffer continuously.
+ * @param Callback: Optional half/complete callback, for refilling the buffer.
+ * @param Context: Passed to Callback.
+ * @return 1 on success, 0 if the timer has no update DMA request or no such channel.
+ */
+uint8_t Mcal_Pwm_Stream_Start(Tim_Id_t Timer, Tim_Channel_t Channel, const void *Compares,
+	uint16_t Count, uint8_t Circular, Dma_Callback_t Callback, void *Context);
+
+/**
+ * @brief Stop duty streaming; the last streamed value stays in effect.
+ * @param Timer: Timer.
+ */
+void Mcal_Pwm_Stream_Stop(Tim_Id_t Timer);
+
+#endif /* PWM_H_ */
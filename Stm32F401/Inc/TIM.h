@@ -0,0 +1,197 @@
+#ifndef TIM_H_
+#define TIM_H_
+
+#include "GPIO.h"
+#include "DMA.h"
+
+/**
+ * @brief Timer kernel clock. With the APB prescalers at their reset value
+ * (divide by 1) every timer runs at the core clock.
+ */
+#ifndef TIM_CLOCK_HZ
+#define TIM_CLOCK_HZ CORE_CLOCK_HZ
+#endif
+
+/**
+ * @brief Enumeration of the STM32F401 timers.
+ */
+typedef enum
+{
+    Tim_1 = 0, /*!< Advanced-control, 16-bit, 4 channels */
+    Tim_2, /*!< General-purpose, 32-bit, 4 channels */
+    Tim_3, /*!< General-purpose, 16-bit, 4 channels */
+    Tim_4, /*!< General-purpose, 16-bit, 4 channels */
+    Tim_5, /*!< General-purpose, 32-bit, 4 channels */
+    Tim_9, /*!< General-purpose, 16-bit, 2 channels, no DMA */
+    Tim_10, /*!< General-purpose, 16-bit, 1 channel, no DMA */
+    Tim_11, /*!< General-purpose, 16-bit, 1 channel, no DMA */
+    Tim_Count /*!< Number of timers */
+} Tim_Id_t;
+
+/**
+ * @brief Enumeration for timer channels.
+ */
+typedef enum
+{
+    Tim_Channel_1 = 0, /*!< Channel 1 */
+    Tim_Channel_2, /*!< Channel 2 */
+    Tim_Channel_3, /*!< Channel 3 */
+    Tim_Channel_4 /*!< Channel 4 */
+} Tim_Channel_t;
+
+/**
+ * @brief Enumeration for capture edges.
+ */
+typedef enum
+{
+    Tim_Rising = 0, /*!< Capture on rising edges */
+    Tim_Falling, /*!< Capture on falling edges */
+    Tim_Both_Edges /*!< Capture on both edges */
+} Tim_Edge_t;
+
+/**
+ * @brief Timer capability flags.
+ */
+#define TIM_CAP_SLAVE   (1U << 0) /*!< Slave-mode controller and TI1 routing to CH2 (PWM input) */
+#define TIM_CAP_ENCODER (1U << 1) /*!< Encoder interface modes */
+
+/**
+ * @brief DMA request routing of one timer event (Controller is NULL if none).
+ */
+typedef struct
+{
+    DMA_TypeDef *Controller; /*!< DMA1, DMA2 or NULL */
+    uint8_t Stream; /*!< Stream number */
+    uint8_t Channel; /*!< Request channel */
+} Tim_Dma_t;
+
+/**
+ * @brief Structure describing a timer instance.
+ */
+typedef struct
+{
+    TIM_TypeDef *Registers; /*!< Register block */
+    volatile uint32_t *Enable_Register; /*!< RCC APB1ENR or APB2ENR */
+    uint8_t Enable_Bit; /*!< Clock enable bit in Enable_Register */
+    uint8_t Alternate_Function; /*!< GPIO alternate function of the timer pins */
+    uint8_t Channels; /*!< Number of capture/compare channels */
+    uint8_t Wide; /*!< 1 for 32-bit counters (TIM2, TIM5) */
+    uint8_t Capabilities; /*!< TIM_CAP_* flags */
+    Tim_Dma_t Channel_Dma[4]; /*!< DMA request of each CCx event */
+    Tim_Dma_t Update_Dma; /*!< DMA request of the update event */
+} Tim_Descriptor_t;
+
+/**
+ * @brief Structure for configuring an input-capture acquisition.
+ */
+typedef struct
+{
+    Tim_Id_t Timer; /*!< Timer (TIM1 to TIM5) */
+    Tim_Channel_t Channel; /*!< Capture channel */
+    Tim_Edge_t Edge; /*!< Edge(s) to timestamp */
+    uint16_t Prescaler; /*!< Counter prescaler (tick = TIM_CLOCK_HZ / (Prescaler + 1)) */
+    uint8_t Filter; /*!< Input filter (0 to 15) */
+    void *Buffer; /*!< Timestamps: uint32_t for TIM2/TIM5, uint16_t otherwise */
+    uint16_t Count; /*!< Number of timestamps in Buffer */
+    uint8_t Circular; /*!< 1 to keep capturing into Buffer as a ring */
+    Dma_Callback_t Callback; /*!< Optional half/complete callback */
+    void *Context; /*!< Passed to Callback */
+} Tim_Capture_Config_t;
+
+/**
+ * @brief Look up a timer's descriptor.
+ * @param Timer: Timer.
+ * @return Descriptor of the timer.
+ */
+const Tim_Descriptor_t *Mcal_Tim_Descriptor(Tim_Id_t Timer);
+
+/**
+ * @brief Enable a timer's clock and stop its counter.
+ * @param Timer: Timer.
+ */
+void Mcal_Tim_Enable(Tim_Id_t Timer);
+
+/**
+ * @brief Connect a pin to a timer through the alternate-function path of Mcal_Gpio_Init.
+ * @param Timer: Timer.
+ * @param GPIOx: Pointer to the GPIO port.
+ * @param Pin_Number: Pin number (must be a pin the timer is routed to).
+ * @param Pulling_State: Pull-up/pull-down configuration.
+ */
+void Mcal_Tim_Pin_Init(Tim_Id_t Timer, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Pulling_t Pulling_State);
+
+/**
+ * @brief Configure input capture with DMA transfers of every timestamp.
+ * @param Config: Capture configuration (must stay valid while running).
+ * @return 1 on success, 0 if the channel has no DMA request, Count is below 2
+ * or Buffer is NULL.
+ */
+uint8_t Mcal_Tim_Capture_Init(const Tim_Capture_Config_t *Config);
+
+/**
+ * @brief Start capturing.
+ * @param Config: Capture configuration.
+ */
+void Mcal_Tim_Capture_Start(const Tim_Capture_Config_t *Config);
+
+/**
+ * @brief Stop capturing.
+ * @param Config: Capture configuration.
+ */
+void Mcal_Tim_Capture_Stop(const Tim_Capture_Config_t *Config);
+
+/**
+ * @brief Index in Buffer that the next timestamp will be written to.
+ * @param Config: Capture configuration.
+ * @return Write index.
+ */
+uint16_t Mcal_Tim_Capture_Head(const Tim_Capture_Config_t *Config);
+
+/**
+ * @brief Ticks between the two most recent timestamps.
+ * @param Config: Capture configuration.
+ * @return Period in timer ticks.
+ */
+uint32_t Mcal_Tim_Capture_Period(const Tim_Capture_Config_t *Config);
+
+/**
+ * @brief Configure PWM-input mode on channel 1: CH1 latches the period and
+ * CH2 the high time of every cycle, and the counter resets on each rising edge.
+ * @param Timer: Timer (TIM1 to TIM5, TIM9).
+ * @param Prescaler: Counter prescaler.
+ * @param Filter: Input filter (0 to 15).
+ * @return 1 on success, 0 if the timer has no slave-mode controller (TIM10, TIM11).
+ */
+uint8_t Mcal_Tim_PwmInput_Init(Tim_Id_t Timer, uint16_t Prescaler, uint8_t Filter);
+
+/**
+ * @brief Read the last measured cycle of a PWM-input timer.
+ * @param Timer: Timer.
+ * @param Period: Period in ticks (0 before the first full cycle).
+ * @param High: High time in ticks.
+ */
+void Mcal_Tim_PwmInput_Read(Tim_Id_t Timer, uint32_t *Period, uint32_t *High);
+
+/**
+ * @brief Configure quadrature encoder mode on channels 1 and 2 (x4 counting).
+ * @param Timer: Timer (TIM1 to TIM5).
+ * @param Filter: Input filter (0 to 15).
+ * @return 1 on success, 0 if the timer has no encoder interface (TIM9 to TIM11).
+ */
+uint8_t Mcal_Tim_Encoder_Init(Tim_Id_t Timer, uint8_t Filter);
+
+/**
+ * @brief Current encoder position.
+ * @param Timer: Timer.
+ * @return Signed position in quadrature counts (wraps at the counter width).
+ */
+int32_t Mcal_Tim_Encoder_Position(Tim_Id_t Timer);
+
+/**
+ * @brief Set the encoder position to zero.
+ * @param Timer: Timer.
+ */
+void Mcal_Tim_Encoder_Reset(Tim_Id_t Timer);
+
+#endif /* TIM_H_ */
@@ -0,0 +1,115 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "stm32f401xc.h"
+
+/**
+ * @brief Master switch for the trace facility.
+ * When 0 (default) every TRACE_* macro expands to nothing and the driver
+ * entry points carry no instrumentation cost. Define TRACE_ENABLE=1 in the
+ * build configuration to record events.
+ */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 0
+#endif
+
+/**
+ * @brief Number of records held in the ring buffer (must be a power of two).
+ */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 256
+#endif
+
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Marker word at the start of the trace buffer ("TRCE").
+ * Lets the host decoder locate the buffer inside a raw RAM dump.
+ */
+#define TRACE_MAGIC 0x45435254UL
+
+/**
+ * @brief Event ID flags, stored in the upper bits of the 16-bit event ID.
+ */
+#define TRACE_FLAG_EXIT 0x8000U /*!< Function exit (pairs with the matching entry) */
+#define TRACE_FLAG_MARK 0x4000U /*!< Instant event, no pairing */
+#define TRACE_ID_MASK   0x3FFFU /*!< Bits holding the event ID itself */
+
+/**
+ * @brief Enumeration of trace event IDs.
+ * The host decoder (Tools/trace_decode.py) reads this enum to name events,
+ * so keep one enumerator per line.
+ */
+typedef enum
+{
+    TRACE_ID_GPIO_INIT = 0x0001, /*!< Mcal_Gpio_Init, arg = port | pin */
+    TRACE_ID_GPIO_DEINIT, /*!< Mcal_Gpio_Deinit, arg = port */
+    TRACE_ID_GPIO_WRITE, /*!< Mcal_Gpio_Write, arg = port | pin */
+    TRACE_ID_GPIO_READ, /*!< Mcal_Gpio_Read, arg = port | pin */
+    TRACE_ID_GPIO_TOGGLE, /*!< Mcal_Gpio_Toggle, arg = port | pin */
+    TRACE_ID_GPIO_RELEASE, /*!< Mcal_Gpio_Release, arg = port | pin */
+    TRACE_ID_LCD_INIT = 0x0040, /*!< LCD_Init, arg = port */
+    TRACE_ID_LCD_INIT_PHASE, /*!< LCD_Init phase mark, arg = phase number */
+    TRACE_ID_LCD_SEND_COMMAND, /*!< LCD_SendCommand, arg = command */
+    TRACE_ID_LCD_SEND_DATA, /*!< LCD_SendData, arg = data */
+    TRACE_ID_LCD_CLEAR, /*!< LCD_Clear */
+    TRACE_ID_LCD_SET_CURSOR, /*!< LCD_SetCursor, arg = (row << 8) | col */
+    TRACE_ID_LCD_PRINT_STRING, /*!< LCD_PrintString, arg = string address */
+    TRACE_ID_USER = 0x1000 /*!< First ID free for application use */
+} Trace_Id_t;
+
+/**
+ * @brief Structure of a single trace record (12 bytes).
+ */
+typedef struct
+{
+    uint32_t Timestamp; /*!< DWT cycle counter at the trace point */
+    uint16_t Id; /*!< Event ID with TRACE_FLAG_* bits */
+    uint16_t Sequence; /*!< Low 16 bits of the record's global index */
+    uint32_t Arg; /*!< Event argument */
+} Trace_Record_t;
+
+/**
+ * @brief Structure of the trace ring buffer as laid out in RAM.
+ */
+typedef struct
+{
+    uint32_t Magic; /*!< TRACE_MAGIC once Mcal_Trace_Init has run */
+    uint32_t Capacity; /*!< Number of records (TRACE_BUFFER_SIZE) */
+    volatile uint32_t Head; /*!< Total number of records ever reserved */
+    uint32_t Reserved; /*!< Keeps Records 8-byte aligned */
+    Trace_Record_t Records[TRACE_BUFFER_SIZE]; /*!< Record storage */
+} Trace_Buffer_t;
+
+/**
+ * @brief The trace buffer; dump it from RAM to decode it on the host.
+ */
+extern Trace_Buffer_t Trace_Buffer;
+
+/**
+ * @brief Start the DWT cycle counter and reset the trace buffer.
+ */
+void Mcal_Trace_Init(void);
+
+/**
+ * @brief Record one event. Safe to call from thread and interrupt context.
+ * @param Id: Event ID, optionally ORed with TRACE_FLAG_EXIT or TRACE_FLAG_MARK.
+ * @param Arg: Event argument.
+ */
+void Mcal_Trace_Event(uint16_t Id, uint32_t Arg);
+
+#if TRACE_ENABLE
+#define TRACE_INIT()          Mcal_Trace_Init()
+#define TRACE_ENTER(Id, Arg)  Mcal_Trace_Event((Id), (uint32_t) (Arg))
+#define TRACE_EXIT(Id, Arg)   Mcal_Trace_Event((Id) | TRACE_FLAG_EXIT, (uint32_t) (Arg))
+#define TRACE_MARK(Id, Arg)   Mcal_Trace_Event((Id) | TRACE_FLAG_MARK, (uint32_t) (Arg))
+#else
+#define TRACE_INIT()          ((void) 0)
+#define TRACE_ENTER(Id, Arg)  ((void) 0)
+#define TRACE_EXIT(Id, Arg)   ((void) 0)
+#define TRACE_MARK(Id, Arg)   ((void) 0)
+#endif
+
+#endif /* TRACE_H_ */
@@ -3,8 +3,45 @@
 
 #include <stdint.h>
 
+/**
+ * @brief Core clock frequency in Hz (HSI after reset, no PLL configured).
+ */
+#ifndef CORE_CLOCK_HZ
+#define CORE_CLOCK_HZ 16000000UL
+#endif
+
+#ifdef HOST_SIM
+/**
+ * @brief RAM backing the peripheral register space in host builds.
+ * Defined in Sim/HostSim.c; see PERIPH_BASE.
+ */
+extern uint32_t HostSim_Peripherals[];
+extern uint32_t HostSim_Private_Peripherals[];
+
+/**
+ * @brief Host-side replacement for the DWT cycle counter.
+ * @return Elapsed host time in nanoseconds (wraps like CYCCNT).
+ */
+uint32_t HostSim_Cycles(void);
+
+/**
+ * @brief Map a peripheral address onto the host RAM register image.
+ * Lets the drivers run unmodified under the host register simulator.
+ */
+#define PERIPH_BASE(Address) ((Address) >= 0xE0000000UL \
+	? (uint8_t *) HostSim_Private_Peripherals + ((Address) - 0xE0000000UL) \
+	: (uint8_t *) HostSim_Peripherals + ((Address) - 0x40000000UL))
+#else
+/**
+ * @brief Peripheral addresses are used as-is on target.
+ */
+#define PERIPH_BASE(Address) (Address)
+#endif
+
 /**
  * @brief Macro to set specific bits in a register.
+ * @note Set, Clear and Toggle are plain read-modify-write; use Set_Atomic and
+ * Clear_Atomic (Lib/Inc/Atomic.h) on registers also written by interrupts.
  * @param Reg: Register to modify.
  * @param bit: Bit position to start setting.
  * @param mask: Value to set in the specified bit position.
@@ -54,17 +91,32 @@ typedef struct
 /**
  * @brief Base address for GPIOA peripheral.
  */
-#define GPIOA ((GPIO_TypeDef *) (0x40020000))
+#define GPIOA ((GPIO_TypeDef *) PERIPH_BASE(0x40020000))
 
 /**
  * @brief Base address for GPIOB peripheral.
  */
-#define GPIOB ((GPIO_TypeDef *) (0x40020400))
+#define GPIOB ((GPIO_TypeDef *) PERIPH_BASE(0x40020400))
 
 /**
  * @brief Base address for GPIOC peripheral.
  */
-#define GPIOC ((GPIO_TypeDef *) (0x40020800))
+#define GPIOC ((GPIO_TypeDef *) PERIPH_BASE(0x40020800))
+
+/**
+ * @brief Base address for GPIOD peripheral.
+ */
+#define GPIOD ((GPIO_TypeDef *) PERIPH_BASE(0x40020C00))
+
+/**
+ * @brief Base address for GPIOE peripheral.
+ */
+#define GPIOE ((GPIO_TypeDef *) PERIPH_BASE(0x40021000))
+
+/**
+ * @brief Base address for GPIOH peripheral.
+ */
+#define GPIOH ((GPIO_TypeDef *) PERIPH_BASE(0x40021C00))
 
 /**
  * @brief Structure for RCC peripheral registers.
@@ -105,51 +157,404 @@ typedef struct
 /**
  * @brief Base address for RCC peripheral.
  */
-#define RCC ((RCC_TypeDef *) (0x40023800))
+#define RCC ((RCC_TypeDef *) PERIPH_BASE(0x40023800))
+
+/**
+ * @brief AHB1ENR/AHB1LPENR/AHB1RSTR bit positions of the GPIO ports.
+ * GPIO clocks are managed by Mcal_Gpio_Init/Mcal_Gpio_Release.
+ */
+#define RCC_AHB1_GPIOA             0
+#define RCC_AHB1_GPIOB             1
+#define RCC_AHB1_GPIOC             2
+#define RCC_AHB1_GPIOD             3
+#define RCC_AHB1_GPIOE             4
+#define RCC_AHB1_GPIOH             7
+
+/**
+ * @brief AHB1ENR/AHB1RSTR bit positions of the DMA controllers.
+ */
+#define RCC_AHB1_DMA1              21
+#define RCC_AHB1_DMA2              22
+
+/**
+ * @brief APB2ENR/APB2RSTR bit position of ADC1.
+ */
+#define RCC_APB2_ADC1              8
+
+/**
+ * @brief Structure for ADC peripheral registers.
+ */
+typedef struct
+{
+    volatile uint32_t SR;           /*!< ADC status register */
+    volatile uint32_t CR1;          /*!< ADC control register 1 */
+    volatile uint32_t CR2;          /*!< ADC control register 2 */
+    volatile uint32_t SMPR1;        /*!< ADC sample time register 1 (channels 10-18) */
+    volatile uint32_t SMPR2;        /*!< ADC sample time register 2 (channels 0-9) */
+    volatile uint32_t JOFR[4];      /*!< ADC injected channel data offset registers */
+    volatile uint32_t HTR;          /*!< ADC watchdog higher threshold register */
+    volatile uint32_t LTR;          /*!< ADC watchdog lower threshold register */
+    volatile uint32_t SQR1;         /*!< ADC regular sequence register 1 (length, SQ13-16) */
+    volatile uint32_t SQR2;         /*!< ADC regular sequence register 2 (SQ7-12) */
+    volatile uint32_t SQR3;         /*!< ADC regular sequence register 3 (SQ1-6) */
+    volatile uint32_t JSQR;         /*!< ADC injected sequence register */
+    volatile uint32_t JDR[4];       /*!< ADC injected data registers */
+    volatile uint32_t DR;           /*!< ADC regular data register */
+} ADC_TypeDef;
+
+/**
+ * @brief Structure for ADC common registers.
+ */
+typedef struct
+{
+    volatile uint32_t CSR;          /*!< ADC common status register */
+    volatile uint32_t CCR;          /*!< ADC common control register */
+    volatile uint32_t CDR;          /*!< ADC common regular data register */
+} ADC_Common_TypeDef;
+
+/**
+ * @brief Base address for ADC1 peripheral.
+ */
+#define ADC1 ((ADC_TypeDef *) PERIPH_BASE(0x40012000))
+
+/**
+ * @brief Base address for ADC common registers.
+ */
+#define ADC_COMMON ((ADC_Common_TypeDef *) PERIPH_BASE(0x40012300))
+
+/**
+ * @brief ADC register bit positions.
+ */
+#define ADC_SR_OVR                 5
+#define ADC_CR1_SCAN               8
+#define ADC_CR1_RES                24
+#define ADC_CR1_OVRIE              26
+#define ADC_CR2_ADON               0
+#define ADC_CR2_CONT               1
+#define ADC_CR2_DMA                8
+#define ADC_CR2_DDS                9
+#define ADC_CR2_SWSTART            30
+#define ADC_SQR1_L                 20
+#define ADC_CCR_ADCPRE             16
+#define ADC_CCR_VBATE              22
+#define ADC_CCR_TSVREFE            23
 
 /**
- * @brief Enable GPIOA clock.
+ * @brief APB2ENR bit position of SYSCFG.
  */
-#define RCC_GPIOA_Enable()   (Set(RCC->AHB1ENR, 0, 1))
+#define RCC_APB2_SYSCFG            14
 
 /**
- * @brief Enable GPIOB clock.
+ * @brief Structure for EXTI peripheral registers.
  */
-#define RCC_GPIOB_Enable()   (Set(RCC->AHB1ENR, 1, 1))
+typedef struct
+{
+    volatile uint32_t IMR;          /*!< EXTI interrupt mask register */
+    volatile uint32_t EMR;          /*!< EXTI event mask register */
+    volatile uint32_t RTSR;         /*!< EXTI rising trigger selection register */
+    volatile uint32_t FTSR;         /*!< EXTI falling trigger selection register */
+    volatile uint32_t SWIER;        /*!< EXTI software interrupt event register */
+    volatile uint32_t PR;           /*!< EXTI pending register (write 1 to clear) */
+} EXTI_TypeDef;
 
 /**
- * @brief Enable GPIOC clock.
+ * @brief Base address for EXTI peripheral.
  */
-#define RCC_GPIOC_Enable()   (Set(RCC->AHB1ENR, 2, 1))
+#define EXTI ((EXTI_TypeDef *) PERIPH_BASE(0x40013C00))
 
 /**
- * @brief Disable GPIOA clock.
+ * @brief Structure for SYSCFG peripheral registers.
  */
-#define RCC_GPIOA_Disable()  (Clear(RCC->AHB1ENR, 0, 1))
+typedef struct
+{
+    volatile uint32_t MEMRMP;       /*!< SYSCFG memory remap register */
+    volatile uint32_t PMC;          /*!< SYSCFG peripheral mode configuration register */
+    volatile uint32_t EXTICR[4];    /*!< SYSCFG external interrupt configuration registers */
+    uint32_t RESERVED[2];           /*!< Reserved */
+    volatile uint32_t CMPCR;        /*!< SYSCFG compensation cell control register */
+} SYSCFG_TypeDef;
 
 /**
- * @brief Disable GPIOB clock.
+ * @brief Base address for SYSCFG peripheral.
  */
-#define RCC_GPIOB_Disable()  (Clear(RCC->AHB1ENR, 1, 1))
+#define SYSCFG ((SYSCFG_TypeDef *) PERIPH_BASE(0x40013800))
 
 /**
- * @brief Disable GPIOC clock.
+ * @brief APB1ENR bit positions of the general-purpose timers.
  */
-#define RCC_GPIOC_Disable()  (Clear(RCC->AHB1ENR, 2, 1))
+#define RCC_APB1_TIM2              0
+#define RCC_APB1_TIM3              1
+#define RCC_APB1_TIM4              2
+#define RCC_APB1_TIM5              3
 
 /**
- * @brief Reset GPIOA peripheral.
+ * @brief APB2ENR bit positions of the advanced-control and small timers.
  */
-#define RCC_GPIOA_Reset()    (Set(RCC->AHB1RSTR, 0, 1))
+#define RCC_APB2_TIM1              0
+#define RCC_APB2_TIM9              16
+#define RCC_APB2_TIM10             17
+#define RCC_APB2_TIM11             18
+
+/**
+ * @brief Structure for TIM peripheral registers.
+ */
+typedef struct
+{
+    volatile uint32_t CR1;          /*!< TIM control register 1 */
+    volatile uint32_t CR2;          /*!< TIM control register 2 */
+    volatile uint32_t SMCR;         /*!< TIM slave mode control register */
+    volatile uint32_t DIER;         /*!< TIM DMA/interrupt enable register */
+    volatile uint32_t SR;           /*!< TIM status register */
+    volatile uint32_t EGR;          /*!< TIM event generation register */
+    volatile uint32_t CCMR[2];      /*!< TIM capture/compare mode registers (channels 1-2, 3-4) */
+    volatile uint32_t CCER;         /*!< TIM capture/compare enable register */
+    volatile uint32_t CNT;          /*!< TIM counter */
+    volatile uint32_t PSC;          /*!< TIM prescaler */
+    volatile uint32_t ARR;          /*!< TIM auto-reload register */
+    volatile uint32_t RCR;          /*!< TIM repetition counter register (TIM1 only) */
+    volatile uint32_t CCR[4];       /*!< TIM capture/compare registers 1-4 */
+    volatile uint32_t BDTR;         /*!< TIM break and dead-time register (TIM1 only) */
+    volatile uint32_t DCR;          /*!< TIM DMA control register */
+    volatile uint32_t DMAR;         /*!< TIM DMA address for full transfer */
+    volatile uint32_t OR;           /*!< TIM option register */
+} TIM_TypeDef;
+
+/**
+ * @brief Base addresses for TIM peripherals.
+ */
+#define TIM1  ((TIM_TypeDef *) PERIPH_BASE(0x40010000))
+#define TIM2  ((TIM_TypeDef *) PERIPH_BASE(0x40000000))
+#define TIM3  ((TIM_TypeDef *) PERIPH_BASE(0x40000400))
+#define TIM4  ((TIM_TypeDef *) PERIPH_BASE(0x40000800))
+#define TIM5  ((TIM_TypeDef *) PERIPH_BASE(0x40000C00))
+#define TIM9  ((TIM_TypeDef *) PERIPH_BASE(0x40014000))
+#define TIM10 ((TIM_TypeDef *) PERIPH_BASE(0x40014400))
+#define TIM11 ((TIM_TypeDef *) PERIPH_BASE(0x40014800))
+
+/**
+ * @brief TIM register bit positions.
+ */
+#define TIM_CR1_CEN                0
+#define TIM_CR1_UDIS               1
+#define TIM_CR1_CMS                5
+#define TIM_CR1_ARPE               7
+#define TIM_SMCR_SMS               0
+#define TIM_SMCR_TS                4
+#define TIM_DIER_UDE               8
+#define TIM_DIER_CC1DE             9
+#define TIM_SR_UIF                 0
+#define TIM_EGR_UG                 0
+#define TIM_CCMR_CCS               0
+#define TIM_CCMR_ICF               4
+#define TIM_CCMR_OCPE              3
+#define TIM_CCMR_OCM               4
+#define TIM_CCER_CCE               0
+#define TIM_CCER_CCP               1
+#define TIM_CCER_CCNP              3
+#define TIM_BDTR_MOE               15
+
+/**
+ * @brief Structure for a DMA stream.
+ */
+typedef struct
+{
+    volatile uint32_t CR;           /*!< DMA stream configuration register */
+    volatile uint32_t NDTR;         /*!< DMA stream number of data register */
+    volatile uint32_t PAR;          /*!< DMA stream peripheral address register */
+    volatile uint32_t M0AR;         /*!< DMA stream memory 0 address register */
+    volatile uint32_t M1AR;         /*!< DMA stream memory 1 address register */
+    volatile uint32_t FCR;          /*!< DMA stream FIFO control register */
+} DMA_Stream_TypeDef;
+
+/**
+ * @brief Structure for DMA controller registers.
+ */
+typedef struct
+{
+    volatile uint32_t LISR;         /*!< DMA low interrupt status register (streams 0-3) */
+    volatile uint32_t HISR;         /*!< DMA high interrupt status register (streams 4-7) */
+    volatile uint32_t LIFCR;        /*!< DMA low interrupt flag clear register */
+    volatile uint32_t HIFCR;        /*!< DMA high interrupt flag clear register */
+    DMA_Stream_TypeDef STREAM[8];   /*!< DMA streams 0-7 */
+} DMA_TypeDef;
+
+/**
+ * @brief Base address for DMA1 peripheral.
+ */
+#define DMA1 ((DMA_TypeDef *) PERIPH_BASE(0x40026000))
+
+/**
+ * @brief Base address for DMA2 peripheral.
+ */
+#define DMA2 ((DMA_TypeDef *) PERIPH_BASE(0x40026400))
+
+/**
+ * @brief DMA stream CR bit positions.
+ */
+#define DMA_SxCR_EN                0
+#define DMA_SxCR_TEIE              2
+#define DMA_SxCR_HTIE              3
+#define DMA_SxCR_TCIE              4
+#define DMA_SxCR_DIR               6
+#define DMA_SxCR_CIRC              8
+#define DMA_SxCR_PINC              9
+#define DMA_SxCR_MINC              10
+#define DMA_SxCR_PSIZE             11
+#define DMA_SxCR_MSIZE             13
+#define DMA_SxCR_PL                16
+#define DMA_SxCR_CHSEL             25
+
+/**
+ * @brief DMA stream flag positions, relative to the stream's flag group.
+ */
+#define DMA_FLAG_FEIF              0
+#define DMA_FLAG_DMEIF             2
+#define DMA_FLAG_TEIF              3
+#define DMA_FLAG_HTIF              4
+#define DMA_FLAG_TCIF              5
+
+/**
+ * @brief Structure for NVIC registers.
+ */
+typedef struct
+{
+    volatile uint32_t ISER[8];      /*!< Interrupt set-enable registers */
+    uint32_t RESERVED0[24];         /*!< Reserved */
+    volatile uint32_t ICER[8];      /*!< Interrupt clear-enable registers */
+    uint32_t RESERVED1[24];         /*!< Reserved */
+    volatile uint32_t ISPR[8];      /*!< Interrupt set-pending registers */
+    uint32_t RESERVED2[24];         /*!< Reserved */
+    volatile uint32_t ICPR[8];      /*!< Interrupt clear-pending registers */
+    uint32_t RESERVED3[24];         /*!< Reserved */
+    volatile uint32_t IABR[8];      /*!< Interrupt active bit registers */
+    uint32_t RESERVED4[56];         /*!< Reserved */
+    volatile uint8_t IP[240];       /*!< Interrupt priority registers (upper 4 bits used) */
+} NVIC_TypeDef;
+
+/**
+ * @brief Base address for NVIC.
+ */
+#define NVIC ((NVIC_TypeDef *) PERIPH_BASE(0xE000E100))
+
+/**
+ * @brief Enable an interrupt in the NVIC (write-one register, no RMW).
+ */
+#define NVIC_Enable(Irq)           (NVIC->ISER[(Irq) >> 5] = (1UL << ((Irq) & 31)))
+
+/**
+ * @brief Disable an interrupt in the NVIC.
+ */
+#define NVIC_Disable(Irq)          (NVIC->ICER[(Irq) >> 5] = (1UL << ((Irq) & 31)))
+
+/**
+ * @brief Set the priority of an interrupt (0 = highest, 15 = lowest).
+ */
+#define NVIC_SetPriority(Irq, Prio) (NVIC->IP[(Irq)] = (uint8_t) ((Prio) << 4))
+
+/**
+ * @brief Interrupt numbers (position in the vector table after the system exceptions).
+ */
+#define EXTI0_IRQn                 6
+#define EXTI1_IRQn                 7
+#define EXTI2_IRQn                 8
+#define EXTI3_IRQn                 9
+#define EXTI4_IRQn                 10
+#define DMA1_Stream0_IRQn          11
+#define DMA1_Stream1_IRQn          12
+#define DMA1_Stream2_IRQn          13
+#define DMA1_Stream3_IRQn          14
+#define DMA1_Stream4_IRQn          15
+#define DMA1_Stream5_IRQn          16
+#define DMA1_Stream6_IRQn          17
+#define ADC_IRQn                   18
+#define EXTI9_5_IRQn               23
+#define TIM1_BRK_TIM9_IRQn         24
+#define TIM1_UP_TIM10_IRQn         25
+#define TIM1_TRG_COM_TIM11_IRQn    26
+#define TIM1_CC_IRQn               27
+#define TIM2_IRQn                  28
+#define TIM3_IRQn                  29
+#define TIM4_IRQn                  30
+#define EXTI15_10_IRQn             40
+#define DMA1_Stream7_IRQn          47
+#define TIM5_IRQn                  50
+#define DMA2_Stream0_IRQn          56
+#define DMA2_Stream1_IRQn          57
+#define DMA2_Stream2_IRQn          58
+#define DMA2_Stream3_IRQn          59
+#define DMA2_Stream4_IRQn          60
+#define DMA2_Stream5_IRQn          68
+#define DMA2_Stream6_IRQn          69
+#define DMA2_Stream7_IRQn          70
+
+/**
+ * @brief Structure for Core Debug registers.
+ */
+typedef struct
+{
+    volatile uint32_t DHCSR;        /*!< Debug halting control and status register */
+    volatile uint32_t DCRSR;        /*!< Debug core register selector register */
+    volatile uint32_t DCRDR;        /*!< Debug core register data register */
+    volatile uint32_t DEMCR;        /*!< Debug exception and monitor control register */
+} CoreDebug_TypeDef;
+
+/**
+ * @brief Base address for Core Debug registers.
+ */
+#define CoreDebug ((CoreDebug_TypeDef *) PERIPH_BASE(0xE000EDF0))
+
+/**
+ * @brief DEMCR trace enable bit (powers the DWT and ITM units).
+ */
+#define CoreDebug_DEMCR_TRCENA     24
+
+/**
+ * @brief Structure for DWT (Data Watchpoint and Trace) unit registers.
+ */
+typedef struct
+{
+    volatile uint32_t CTRL;         /*!< DWT control register */
+    volatile uint32_t CYCCNT;       /*!< DWT cycle count register */
+    volatile uint32_t CPICNT;       /*!< DWT CPI count register */
+    volatile uint32_t EXCCNT;       /*!< DWT exception overhead count register */
+    volatile uint32_t SLEEPCNT;     /*!< DWT sleep count register */
+    volatile uint32_t LSUCNT;       /*!< DWT LSU count register */
+    volatile uint32_t FOLDCNT;      /*!< DWT folded-instruction count register */
+    volatile uint32_t PCSR;         /*!< DWT program counter sample register */
+} DWT_TypeDef;
+
+/**
+ * @brief Base address for DWT unit.
+ */
+#define DWT ((DWT_TypeDef *) PERIPH_BASE(0xE0001000))
+
+/**
+ * @brief DWT CTRL cycle counter enable bit.
+ */
+#define DWT_CTRL_CYCCNTENA         0
+
+/**
+ * @brief Structure for ITM (Instrumentation Trace Macrocell) registers.
+ */
+typedef struct
+{
+    volatile uint32_t PORT[32];     /*!< ITM stimulus port registers */
+    uint32_t RESERVED0[864];        /*!< Reserved */
+    volatile uint32_t TER;          /*!< ITM trace enable register */
+    uint32_t RESERVED1[15];         /*!< Reserved */
+    volatile uint32_t TPR;          /*!< ITM trace privilege register */
+    uint32_t RESERVED2[15];         /*!< Reserved */
+    volatile uint32_t TCR;          /*!< ITM trace control register */
+} ITM_TypeDef;
 
 /**
- * @brief Reset GPIOB peripheral.
+ * @brief Base address for ITM unit.
  */
-#define RCC_GPIOB_Reset()    (Set(RCC->AHB1RSTR, 1, 1))
+#define ITM ((ITM_TypeDef *) PERIPH_BASE(0xE0000000))
 
 /**
- * @brief Reset GPIOC peripheral.
+ * @brief ITM TCR global enable bit.
  */
-#define RCC_GPIOC_Reset()    (Set(RCC->AHB1RSTR, 2, 1))
+#define ITM_TCR_ITMENA             0
 
 #endif /* STM32F401XC_H_ */
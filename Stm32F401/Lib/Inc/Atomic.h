@@ -0,0 +1,290 @@
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+#include "../../Inc/stm32f401xc.h"
+
+/**
+ * @brief Number of implemented NVIC priority bits on the STM32F4.
+ */
+#define ATOMIC_PRIORITY_BITS 4
+
+/**
+ * @brief Atomic primitives for data shared between interrupts and the main loop.
+ *
+ * Read-modify-write operations on RAM use LDREX/STREX retry loops: the
+ * exclusive monitor is cleared on every exception entry and return, so an
+ * interrupt landing between the load and the store makes the store fail and
+ * the operation retries with the new value. No interrupt is ever masked.
+ *
+ * Exclusive accesses are only defined for normal memory, so peripheral
+ * registers shared with interrupts go through Atomic_Modify, which uses a
+ * short PRIMASK critical section instead (or BSRR for GPIO outputs).
+ *
+ * Under HOST_SIM the same API maps onto the compiler __atomic builtins, and
+ * the critical sections are no-ops.
+ */
+
+#ifndef HOST_SIM
+
+/**
+ * @brief  Full memory barrier (orders accesses for DMA and other bus masters too).
+ * @return None
+ */
+static inline void Atomic_Barrier(void)
+    {
+    __asm volatile ("dmb" : : : "memory");
+    }
+
+/**
+ * @brief  Loads a shared word; later accesses are not moved before it.
+ * @param  Address: Shared word.
+ * @return Current value.
+ */
+static inline uint32_t Atomic_Load(const volatile uint32_t *Address)
+    {
+    uint32_t Value = *Address;
+
+    Atomic_Barrier();
+    return Value;
+    }
+
+/**
+ * @brief  Stores a shared word; earlier accesses are completed before it.
+ * @param  Address: Shared word.
+ * @param  Value: New value.
+ * @return None
+ */
+static inline void Atomic_Store(volatile uint32_t *Address, uint32_t Value)
+    {
+    Atomic_Barrier();
+    *Address = Value;
+    }
+
+/**
+ * @brief  Atomically adds to a word.
+ * @param  Address: Shared word.
+ * @param  Value: Addend.
+ * @return Value before the addition.
+ */
+static inline uint32_t Atomic_FetchAdd(volatile uint32_t *Address, uint32_t Value)
+    {
+    uint32_t Old;
+    uint32_t Failed;
+
+    do
+	{
+	__asm volatile ("ldrex %0, [%1]" : "=r" (Old) : "r" (Address) : "memory");
+	__asm volatile ("strex %0, %2, [%1]" : "=&r" (Failed) : "r" (Address), "r" (Old + Value) : "memory");
+	}
+    while (Failed);
+
+    return Old;
+    }
+
+/**
+ * @brief  Atomically sets bits in a word.
+ * @param  Address: Shared word.
+ * @param  Mask: Bits to set.
+ * @return Value before the operation.
+ */
+static inline uint32_t Atomic_FetchOr(volatile uint32_t *Address, uint32_t Mask)
+    {
+    uint32_t Old;
+    uint32_t Failed;
+
+    do
+	{
+	__asm volatile ("ldrex %0, [%1]" : "=r" (Old) : "r" (Address) : "memory");
+	__asm volatile ("strex %0, %2, [%1]" : "=&r" (Failed) : "r" (Address), "r" (Old | Mask) : "memory");
+	}
+    while (Failed);
+
+    return Old;
+    }
+
+/**
+ * @brief  Atomically clears bits in a word.
+ * @param  Address: Shared word.
+ * @param  Mask: Bits to clear.
+ * @return Value before the operation.
+ */
+static inline uint32_t Atomic_FetchAndNot(volatile uint32_t *Address, uint32_t Mask)
+    {
+    uint32_t Old;
+    uint32_t Failed;
+
+    do
+	{
+	__asm volatile ("ldrex %0, [%1]" : "=r" (Old) : "r" (Address) : "memory");
+	__asm volatile ("strex %0, %2, [%1]" : "=&r" (Failed) : "r" (Address), "r" (Old & ~Mask) : "memory");
+	}
+    while (Failed);
+
+    return Old;
+    }
+
+/**
+ * @brief  Replaces a word if it still holds the expected value.
+ * @param  Address: Shared word.
+ * @param  Expected: Expected value; updated with the current value on failure.
+ * @param  Desired: New value.
+ * @return 1 if the word was replaced, 0 otherwise.
+ */
+static inline uint8_t Atomic_CompareExchange(volatile uint32_t *Address, uint32_t *Expected,
+	uint32_t Desired)
+    {
+    uint32_t Current;
+    uint32_t Failed;
+
+    do
+	{
+	__asm volatile ("ldrex %0, [%1]" : "=r" (Current) : "r" (Address) : "memory");
+	if (Current != *Expected)
+	    {
+	    // Drop the reservation so a later STREX in this context cannot succeed on it
+	    __asm volatile ("clrex" : : : "memory");
+	    *Expected = Current;
+	    return 0;
+	    }
+	__asm volatile ("strex %0, %2, [%1]" : "=&r" (Failed) : "r" (Address), "r" (Desired) : "memory");
+	}
+    while (Failed);
+
+    return 1;
+    }
+
+/**
+ * @brief  Masks all maskable interrupts.
+ * @return PRIMASK before masking, for Atomic_IrqRestore.
+ */
+static inline uint32_t Atomic_IrqSave(void)
+    {
+    uint32_t Primask;
+
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (Primask) : : "memory");
+    return Primask;
+    }
+
+/**
+ * @brief  Restores PRIMASK saved by Atomic_IrqSave.
+ * @param  Primask: Value returned by Atomic_IrqSave.
+ * @return None
+ */
+static inline void Atomic_IrqRestore(uint32_t Primask)
+    {
+    __asm volatile ("msr primask, %0" : : "r" (Primask) : "memory");
+    }
+
+/**
+ * @brief  Masks interrupts of the given priority and lower urgency; more
+ *         urgent interrupts keep running. BASEPRI_MAX never lowers an
+ *         already raised mask, so sections nest.
+ * @param  Priority: NVIC priority (0 to 15) to mask from; 0 has no effect.
+ * @return BASEPRI before masking, for Atomic_MaskRestore.
+ */
+static inline uint32_t Atomic_MaskSave(uint8_t Priority)
+    {
+    uint32_t Basepri;
+    uint32_t Level = (uint32_t) Priority << (8 - ATOMIC_PRIORITY_BITS);
+
+    __asm volatile ("mrs %0, basepri" : "=r" (Basepri) : : "memory");
+    __asm volatile ("msr basepri_max, %0" : : "r" (Level) : "memory");
+    return Basepri;
+    }
+
+/**
+ * @brief  Restores BASEPRI saved by Atomic_MaskSave.
+ * @param  Basepri: Value returned by Atomic_MaskSave.
+ * @return None
+ */
+static inline void Atomic_MaskRestore(uint32_t Basepri)
+    {
+    __asm volatile ("msr basepri, %0" : : "r" (Basepri) : "memory");
+    }
+
+#else /* HOST_SIM */
+
+static inline void Atomic_Barrier(void)
+    {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
+static inline uint32_t Atomic_Load(const volatile uint32_t *Address)
+    {
+    return __atomic_load_n(Address, __ATOMIC_ACQUIRE);
+    }
+
+static inline void Atomic_Store(volatile uint32_t *Address, uint32_t Value)
+    {
+    __atomic_store_n(Address, Value, __ATOMIC_RELEASE);
+    }
+
+static inline uint32_t Atomic_FetchAdd(volatile uint32_t *Address, uint32_t Value)
+    {
+    return __atomic_fetch_add(Address, Value, __ATOMIC_ACQ_REL);
+    }
+
+static inline uint32_t Atomic_FetchOr(volatile uint32_t *Address, uint32_t Mask)
+    {
+    return __atomic_fetch_or(Address, Mask, __ATOMIC_ACQ_REL);
+    }
+
+static inline uint32_t Atomic_FetchAndNot(volatile uint32_t *Address, uint32_t Mask)
+    {
+    return __atomic_fetch_and(Address, ~Mask, __ATOMIC_ACQ_REL);
+    }
+
+static inline uint8_t Atomic_CompareExchange(volatile uint32_t *Address, uint32_t *Expected,
+	uint32_t Desired)
+    {
+    return __atomic_compare_exchange_n(Address, Expected, Desired, 0, __ATOMIC_ACQ_REL,
+	    __ATOMIC_ACQUIRE);
+    }
+
+static inline uint32_t Atomic_IrqSave(void)
+    {
+    return 0;
+    }
+
+static inline void Atomic_IrqRestore(uint32_t Primask)
+    {
+    (void) Primask;
+    }
+
+static inline uint32_t Atomic_MaskSave(uint8_t Priority)
+    {
+    (void) Priority;
+    return 0;
+    }
+
+static inline void Atomic_MaskRestore(uint32_t Basepri)
+    {
+    (void) Basepri;
+    }
+
+#endif /* HOST_SIM */
+
+/**
+ * @brief  Interrupt-safe read-modify-write of a peripheral register: the
+ *         Set/Clear macros are plain RMW and lose updates made by an
+ *         interrupt between their read and write.
+ * @param  Reg: Register.
+ * @param  Clear_Mask: Bits to clear.
+ * @param  Set_Mask: Bits to set (applied after clearing).
+ * @return None
+ */
+static inline void Atomic_Modify(volatile uint32_t *Reg, uint32_t Clear_Mask, uint32_t Set_Mask)
+    {
+    uint32_t Primask = Atomic_IrqSave();
+
+    *Reg = (*Reg & ~Clear_Mask) | Set_Mask;
+    Atomic_IrqRestore(Primask);
+    }
+
+/**
+ * @brief Interrupt-safe counterparts of Set/Clear for registers shared with interrupts.
+ */
+#define Set_Atomic(Reg, bit, mask)   Atomic_Modify(&(Reg), 0, (uint32_t) (mask) << (bit))
+#define Clear_Atomic(Reg, bit, mask) Atomic_Modify(&(Reg), (uint32_t) (mask) << (bit), 0)
+
+#endif /* ATOMIC_H_ */
@@ -0,0 +1,111 @@
+#ifndef RING_H_
+#define RING_H_
+
+#include "Atomic.h"
+
+/**
+ * @brief Lock-free ring buffers for passing fixed-size elements between
+ * interrupts and the main loop. Capacities must be powers of two so that
+ * indices are free-running counters masked into the storage.
+ *
+ * Ring_Spsc_t: one producer and one consumer (e.g. a UART RX interrupt
+ * feeding the main loop). Each side only writes its own index.
+ *
+ * Ring_Mpsc_t: any number of producers (interrupts of different priorities,
+ * the main loop) and one consumer. Producers claim a slot with a
+ * compare-and-swap on the head, then publish it through a per-slot sequence
+ * number, so a producer preempted mid-copy never blocks the others; the
+ * consumer just sees that slot as not ready yet.
+ */
+
+/**
+ * @brief Storage size in 32-bit words of a Ring_Mpsc_t (sequence word + rounded-up element per slot).
+ */
+#define RING_MPSC_STORAGE_WORDS(Capacity, Element_Size) \
+    ((Capacity) * (1 + ((Element_Size) + 3) / 4))
+
+/**
+ * @brief Single-producer, single-consumer ring.
+ */
+typedef struct
+{
+    uint8_t *Storage; /*!< Capacity * Element_Size bytes */
+    uint32_t Mask; /*!< Capacity - 1 */
+    uint16_t Element_Size; /*!< Size of one element in bytes */
+    volatile uint32_t Head; /*!< Elements ever pushed (written by the producer) */
+    volatile uint32_t Tail; /*!< Elements ever popped (written by the consumer) */
+} Ring_Spsc_t;
+
+/**
+ * @brief Multi-producer, single-consumer ring.
+ */
+typedef struct
+{
+    uint32_t *Storage; /*!< RING_MPSC_STORAGE_WORDS(Capacity, Element_Size) words */
+    uint32_t Mask; /*!< Capacity - 1 */
+    uint16_t Element_Size; /*!< Size of one element in bytes */
+    uint16_t Stride; /*!< Slot size in words */
+    volatile uint32_t Head; /*!< Next position to claim (shared by producers) */
+    uint32_t Tail; /*!< Next position to pop (consumer only) */
+} Ring_Mpsc_t;
+
+/**
+ * @brief Initialize an SPSC ring.
+ * @param Ring: Ring to initialize.
+ * @param Storage: Capacity * Element_Size bytes.
+ * @param Capacity: Number of elements, a power of two.
+ * @param Element_Size: Size of one element in bytes.
+ * @return 1 on success, 0 if Capacity is not a power of two.
+ */
+uint8_t Ring_Spsc_Init(Ring_Spsc_t *Ring, void *Storage, uint32_t Capacity, uint16_t Element_Size);
+
+/**
+ * @brief Push an element (producer side).
+ * @param Ring: Ring.
+ * @param Element: Element to copy in.
+ * @return 1 on success, 0 if the ring is full.
+ */
+uint8_t Ring_Spsc_Push(Ring_Spsc_t *Ring, const void *Element);
+
+/**
+ * @brief Pop the oldest element (consumer side).
+ * @param Ring: Ring.
+ * @param Element: Destination of the element.
+ * @return 1 on success, 0 if the ring is empty.
+ */
+uint8_t Ring_Spsc_Pop(Ring_Spsc_t *Ring, void *Element);
+
+/**
+ * @brief Number of elements waiting (exact on either side, a snapshot elsewhere).
+ * @param Ring: Ring.
+ * @return Element count.
+ */
+uint32_t Ring_Spsc_Count(const Ring_Spsc_t *Ring);
+
+/**
+ * @brief Initialize an MPSC ring.
+ * @param Ring: Ring to initialize.
+ * @param Storage: RING_MPSC_STORAGE_WORDS(Capacity, Element_Size) words.
+ * @param Capacity: Number of elements, a power of two.
+ * @param Element_Size: Size of one element in bytes.
+ * @return 1 on success, 0 if Capacity is not a power of two.
+ */
+uint8_t Ring_Mpsc_Init(Ring_Mpsc_t *Ring, uint32_t *Storage, uint32_t Capacity, uint16_t Element_Size);
+
+/**
+ * @brief Push an element; safe from any context, including nested interrupts.
+ * @param Ring: Ring.
+ * @param Element: Element to copy in.
+ * @return 1 on success, 0 if the ring is full.
+ */
+uint8_t Ring_Mpsc_Push(Ring_Mpsc_t *Ring, const void *Element);
+
+/**
+ * @brief Pop the oldest published element (consumer side).
+ * @param Ring: Ring.
+ * @param Element: Destination of the element.
+ * @return 1 on success, 0 if the ring is empty or the oldest slot is still being written.
+ */
+uint8_t Ring_Mpsc_Pop(Ring_Mpsc_t *Ring, void *Element);
+
+#endif /* RING_H_ */
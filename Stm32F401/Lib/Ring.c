@@ -0,0 +1,209 @@
+/*
+ * Ring.c
+ *
+ *  Created on: Oct 14, 2024
+ *      Author: xcite
+ */
+
+#include "Inc/Ring.h"
+#include <string.h>
+
+/**
+ * @brief  Checks that a capacity is a non-zero power of two.
+ * @param  Capacity: Number of elements.
+ * @return 1 if valid, 0 otherwise.
+ */
+static inline uint8_t Ring_ValidCapacity(uint32_t Capacity)
+    {
+    return (Capacity != 0) && ((Capacity & (Capacity - 1)) == 0);
+    }
+
+//---------------------------------------------------------//
+
+/**
+ * @brief  Initializes an SPSC ring.
+ * @param  Ring: Ring to initialize.
+ * @param  Storage: Element storage.
+ * @param  Capacity: Number of elements, a power of two.
+ * @param  Element_Size: Size of one element in bytes.
+ * @return 1 on success, 0 if Capacity is not a power of two.
+ */
+uint8_t Ring_Spsc_Init(Ring_Spsc_t *Ring, void *Storage, uint32_t Capacity, uint16_t Element_Size)
+    {
+    if (!Ring_ValidCapacity(Capacity))
+	{
+	return 0;
+	}
+
+    Ring->Storage = Storage;
+    Ring->Mask = Capacity - 1;
+    Ring->Element_Size = Element_Size;
+    Ring->Head = 0;
+    Ring->Tail = 0;
+    return 1;
+    }
+
+/**
+ * @brief  Pushes an element.
+ * @param  Ring: Ring.
+ * @param  Element: Element to copy in.
+ * @return 1 on success, 0 if the ring is full.
+ */
+uint8_t Ring_Spsc_Push(Ring_Spsc_t *Ring, const void *Element)
+    {
+    uint32_t Head = Ring->Head;
+
+    // Free-running indices: the difference is the fill level even across wrap
+    if ((Head - Atomic_Load(&Ring->Tail)) > Ring->Mask)
+	{
+	return 0;
+	}
+
+    memcpy(&Ring->Storage[(Head & Ring->Mask) * Ring->Element_Size], Element, Ring->Element_Size);
+
+    // Publish the element only after it has been written
+    Atomic_Store(&Ring->Head, Head + 1);
+    return 1;
+    }
+
+/**
+ * @brief  Pops the oldest element.
+ * @param  Ring: Ring.
+ * @param  Element: Destination of the element.
+ * @return 1 on success, 0 if the ring is empty.
+ */
+uint8_t Ring_Spsc_Pop(Ring_Spsc_t *Ring, void *Element)
+    {
+    uint32_t Tail = Ring->Tail;
+
+    if (Atomic_Load(&Ring->Head) == Tail)
+	{
+	return 0;
+	}
+
+    memcpy(Element, &Ring->Storage[(Tail & Ring->Mask) * Ring->Element_Size], Ring->Element_Size);
+
+    // Hand the slot back only after it has been read
+    Atomic_Store(&Ring->Tail, Tail + 1);
+    return 1;
+    }
+
+/**
+ * @brief  Returns the number of elements waiting.
+ * @param  Ring: Ring.
+ * @return Element count.
+ */
+uint32_t Ring_Spsc_Count(const Ring_Spsc_t *Ring)
+    {
+    return Ring->Head - Ring->Tail;
+    }
+
+//---------------------------------------------------------//
+
+/**
+ * @brief  Returns the sequence word of the slot of a position.
+ * @param  Ring: Ring.
+ * @param  Position: Free-running position.
+ * @return Slot sequence word; the element follows it.
+ */
+static inline volatile uint32_t *Ring_Mpsc_Slot(Ring_Mpsc_t *Ring, uint32_t Position)
+    {
+    return &Ring->Storage[(Position & Ring->Mask) * Ring->Stride];
+    }
+
+/**
+ * @brief  Initializes an MPSC ring.
+ * @param  Ring: Ring to initialize.
+ * @param  Storage: Slot storage.
+ * @param  Capacity: Number of elements, a power of two.
+ * @param  Element_Size: Size of one element in bytes.
+ * @return 1 on success, 0 if Capacity is not a power of two.
+ */
+uint8_t Ring_Mpsc_Init(Ring_Mpsc_t *Ring, uint32_t *Storage, uint32_t Capacity, uint16_t Element_Size)
+    {
+    if (!Ring_ValidCapacity(Capacity))
+	{
+	return 0;
+	}
+
+    Ring->Storage = Storage;
+    Ring->Mask = Capacity - 1;
+    Ring->Element_Size = Element_Size;
+    Ring->Stride = (uint16_t) (1 + (Element_Size + 3) / 4);
+    Ring->Head = 0;
+    Ring->Tail = 0;
+
+    // A slot whose sequence equals the position is free for that position
+    for (uint32_t i = 0; i < Capacity; i++)
+	{
+	*Ring_Mpsc_Slot(Ring, i) = i;
+	}
+    return 1;
+    }
+
+/**
+ * @brief  Pushes an element from any context.
+ * @param  Ring: Ring.
+ * @param  Element: Element to copy in.
+ * @return 1 on success, 0 if the ring is full.
+ */
+uint8_t Ring_Mpsc_Push(Ring_Mpsc_t *Ring, const void *Element)
+    {
+    uint32_t Position = Atomic_Load(&Ring->Head);
+    volatile uint32_t *Slot;
+
+    for (;;)
+	{
+	Slot = Ring_Mpsc_Slot(Ring, Position);
+	int32_t Lag = (int32_t) (Atomic_Load(Slot) - Position);
+
+	if (Lag == 0)
+	    {
+	    // Slot is free for this lap: claim the position (Position is refreshed on failure)
+	    if (Atomic_CompareExchange(&Ring->Head, &Position, Position + 1))
+		{
+		break;
+		}
+	    }
+	else if (Lag < 0)
+	    {
+	    // Slot still holds the element of the previous lap
+	    return 0;
+	    }
+	else
+	    {
+	    // Another producer claimed this position first
+	    Position = Atomic_Load(&Ring->Head);
+	    }
+	}
+
+    memcpy((void *) (Slot + 1), Element, Ring->Element_Size);
+
+    // Mark the slot ready for the consumer
+    Atomic_Store(Slot, Position + 1);
+    return 1;
+    }
+
+/**
+ * @brief  Pops the oldest published element.
+ * @param  Ring: Ring.
+ * @param  Element: Destination of the element.
+ * @return 1 on success, 0 if nothing is ready.
+ */
+uint8_t Ring_Mpsc_Pop(Ring_Mpsc_t *Ring, void *Element)
+    {
+    uint32_t Position = Ring->Tail;
+    volatile uint32_t *Slot = Ring_Mpsc_Slot(Ring, Position);
+
+    if (Atomic_Load(Slot) != Position + 1)
+	{
+	return 0;
+	}
+
+    memcpy(Element, (const void *) (Slot + 1), Ring->Element_Size);
+
+    // Free the slot for the producer one lap ahead
+    Atomic_Store(Slot, Position + Ring->Mask + 1);
+    Ring->Tail = Position + 1;
+    return 1;
+    }
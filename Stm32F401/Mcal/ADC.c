@@ -0,0 +1,325 @@
+/*
+ * ADC.c
+ *
+ *  Created on: Sep 23, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/ADC.h"
+#include "../Inc/DMA.h"
+#include <stddef.h>
+
+/**
+ * @brief ADC1 is served by DMA2 stream 0, channel 0.
+ */
+#define ADC_DMA        DMA2
+#define ADC_DMA_STREAM 0
+#define ADC_DMA_CHANNEL 0
+
+static const Adc_Config_t *Adc_Config;
+static volatile uint32_t Adc_Overruns;
+static volatile uint32_t Adc_Dma_Errors;
+
+/**
+ * @brief  Returns the port of a pin-routed channel.
+ * @param  Channel: Channel 0 to 15.
+ * @return GPIO port of the channel's pin.
+ */
+static GPIO_TypeDef *Adc_ChannelPort(Adc_Channel_t Channel)
+    {
+    if (Channel <= Adc_Channel_7)
+	{
+	return GPIOA;
+	}
+    else if (Channel <= Adc_Channel_9)
+	{
+	return GPIOB;
+	}
+    return GPIOC;
+    }
+
+/**
+ * @brief  Returns the pin number of a pin-routed channel.
+ * @param  Channel: Channel 0 to 15.
+ * @return Pin index of the channel's pin.
+ */
+static Pin_index_t Adc_ChannelPin(Adc_Channel_t Channel)
+    {
+    if (Channel <= Adc_Channel_7)
+	{
+	return (Pin_index_t) Channel;
+	}
+    else if (Channel <= Adc_Channel_9)
+	{
+	return (Pin_index_t) (Channel - Adc_Channel_8);
+	}
+    return (Pin_index_t) (Channel - Adc_Channel_10);
+    }
+
+/**
+ * @brief  Restarts the DMA stream from the start of the buffer, keeping frames
+ *         aligned, and resumes conversions.
+ * @return None
+ */
+static void Adc_Restart(void)
+    {
+    Clear(ADC1->CR2, ADC_CR2_DMA, 1);
+    Mcal_Dma_Stop(ADC_DMA, ADC_DMA_STREAM);
+    Clear(ADC1->SR, ADC_SR_OVR, 1);
+    Mcal_Dma_Start(ADC_DMA, ADC_DMA_STREAM, &ADC1->DR, Adc_Config->Buffer,
+	    (uint16_t) (Adc_Config->Frames * Adc_Config->Channel_Count));
+    Set(ADC1->CR2, ADC_CR2_DMA, 1);
+    Set(ADC1->CR2, ADC_CR2_SWSTART, 1);
+    }
+
+/**
+ * @brief  Averages one half of the circular buffer and hands it to the application.
+ * @param  Event: DMA event.
+ * @param  Context: Unused.
+ * @return None
+ */
+static void Adc_DmaCallback(Dma_Event_t Event, void *Context)
+    {
+    const Adc_Config_t *Config = Adc_Config;
+    uint16_t Frames = Config->Frames / 2;
+    uint8_t Count = Config->Channel_Count;
+    const uint16_t *Block;
+    uint32_t Sums[ADC_MAX_CHANNELS] = {0};
+    uint16_t Averages[ADC_MAX_CHANNELS];
+
+    (void) Context;
+
+    if (Event == Dma_Half_Transfer)
+	{
+	Block = Config->Buffer;
+	}
+    else if (Event == Dma_Transfer_Complete)
+	{
+	Block = Config->Buffer + (uint32_t) Frames * Count;
+	}
+    else
+	{
+	// A transfer error disables the stream, so conversions would overrun from here on
+	Adc_Dma_Errors++;
+	Adc_Restart();
+	return;
+	}
+
+    //---------------------------------------------------------//
+
+    // Decimate: one averaged value per channel for the whole half buffer
+    const uint16_t *Sample = Block;
+    for (uint16_t Frame = 0; Frame < Frames; Frame++)
+	{
+	for (uint8_t i = 0; i < Count; i++)
+	    {
+	    Sums[i] += *Sample++;
+	    }
+	}
+    for (uint8_t i = 0; i < Count; i++)
+	{
+	Averages[i] = (uint16_t) ((Sums[i] + Frames / 2) / Frames);
+	}
+
+    if (Config->Callback != NULL)
+	{
+	Config->Callback(Averages, Block, Frames);
+	}
+    }
+
+/**
+ * @brief  Checks that a channel exists on the F401.
+ * @param  Channel: Channel.
+ * @return 1 if valid, 0 otherwise.
+ */
+static uint8_t Adc_ValidChannel(Adc_Channel_t Channel)
+    {
+    // Channel 16 is unconnected on the F401 and 18 is the last input
+    return (Channel <= Adc_Channel_15) || (Channel == Adc_Channel_Vrefint)
+	    || (Channel == Adc_Channel_Temperature) || (Channel == Adc_Channel_Vbat);
+    }
+
+/**
+ * @brief  Checks a configuration against the hardware limits.
+ * @param  Config: Acquisition configuration.
+ * @return 1 if valid, 0 otherwise.
+ */
+static uint8_t Adc_ValidConfig(const Adc_Config_t *Config)
+    {
+    uint8_t Temperature = 0;
+    uint8_t Vbat = 0;
+
+    // Each callback averages half the buffer, and NDTR is 16 bits wide
+    if ((Config->Channel_Count == 0) || (Config->Channel_Count > ADC_MAX_CHANNELS)
+	    || (Config->Frames == 0) || (Config->Frames % 2)
+	    || ((uint32_t) Config->Frames * Config->Channel_Count > 0xFFFF))
+	{
+	return 0;
+	}
+
+    // Every channel must exist; temperature sensor and VBAT share channel 18
+    for (uint8_t i = 0; i < Config->Channel_Count; i++)
+	{
+	if (!Adc_ValidChannel(Config->Channels[i]))
+	    {
+	    return 0;
+	    }
+	Temperature |= (Config->Channels[i] == Adc_Channel_Temperature);
+	Vbat |= (Config->Channels[i] == Adc_Channel_Vbat);
+	}
+    return !(Temperature && Vbat);
+    }
+
+/**
+ * @brief  Configures ADC1 in scan + continuous mode with circular DMA.
+ * @param  Config: Acquisition configuration.
+ * @return 1 on success, 0 if the configuration is invalid.
+ */
+uint8_t Mcal_Adc_Init(const Adc_Config_t *Config)
+    {
+    if (!Adc_ValidConfig(Config))
+	{
+	return 0;
+	}
+
+    Adc_Config = Config;
+    Adc_Overruns = 0;
+    Adc_Dma_Errors = 0;
+
+    // Enable the ADC clock and switch the converter off while configuring
+    Set(RCC->APB2ENR, RCC_APB2_ADC1, 1);
+    Clear(ADC1->CR2, ADC_CR2_ADON, 1);
+
+    //---------------------------------------------------------//
+
+    // Program the sequence, sampling times and analog pins
+    uint32_t Sqr[3] = {0};
+    uint32_t Smpr1 = 0;
+    uint32_t Smpr2 = 0;
+
+    // VBAT stays disconnected unless requested, or channel 18 would read VBAT
+    Clear(ADC_COMMON->CCR, ADC_CCR_VBATE, 1);
+
+    for (uint8_t i = 0; i < Config->Channel_Count; i++)
+	{
+	Adc_Channel_t Channel = Config->Channels[i];
+	uint32_t Number = Channel & ADC_CHANNEL_NUMBER_MASK;
+
+	// SQR3 holds ranks 1-6, SQR2 ranks 7-12, SQR1 ranks 13-16
+	Set(Sqr[i / 6], (i % 6) * 5, Number);
+
+	if (Number < Adc_Channel_10)
+	    {
+	    Set(Smpr2, Number * 3, (uint32_t) Config->Sample_Time);
+	    }
+	else
+	    {
+	    Set(Smpr1, (Number - Adc_Channel_10) * 3, (uint32_t) Config->Sample_Time);
+	    }
+
+	if (Channel <= Adc_Channel_15)
+	    {
+	    Pin_t Pin = {0};
+	    Pin.Pin_Number = Adc_ChannelPin(Channel);
+	    Pin.Functionality = Analog;
+	    Mcal_Gpio_Init(Adc_ChannelPort(Channel), &Pin);
+	    }
+	else if (Channel == Adc_Channel_Vbat)
+	    {
+	    Set(ADC_COMMON->CCR, ADC_CCR_VBATE, 1);
+	    }
+	else
+	    {
+	    // Temperature sensor and VREFINT share one enable bit
+	    Set(ADC_COMMON->CCR, ADC_CCR_TSVREFE, 1);
+	    }
+	}
+
+    Set(Sqr[2], ADC_SQR1_L, (uint32_t) (Config->Channel_Count - 1));
+    ADC1->SQR3 = Sqr[0];
+    ADC1->SQR2 = Sqr[1];
+    ADC1->SQR1 = Sqr[2];
+    ADC1->SMPR1 = Smpr1;
+    ADC1->SMPR2 = Smpr2;
+
+    Clear(ADC_COMMON->CCR, ADC_CCR_ADCPRE, 0b11);
+    Set(ADC_COMMON->CCR, ADC_CCR_ADCPRE, Config->Prescaler);
+
+    //---------------------------------------------------------//
+
+    // 12-bit scan with overrun interrupt; continuous conversions feeding DMA
+    ADC1->CR1 = (1UL << ADC_CR1_SCAN) | (1UL << ADC_CR1_OVRIE);
+    ADC1->CR2 = (1UL << ADC_CR2_CONT) | (1UL << ADC_CR2_DMA) | (1UL << ADC_CR2_DDS);
+    NVIC_Enable(ADC_IRQn);
+
+    Dma_Config_t Dma = {0};
+    Dma.Controller = ADC_DMA;
+    Dma.Stream = ADC_DMA_STREAM;
+    Dma.Channel = ADC_DMA_CHANNEL;
+    Dma.Direction = Dma_Peripheral_To_Memory;
+    Dma.Peripheral_Size = Dma_Half_Word;
+    Dma.Memory_Size = Dma_Half_Word;
+    Dma.Memory_Increment = 1;
+    Dma.Circular = 1;
+    Dma.Priority = Dma_Priority_High;
+    Dma.Callback = Adc_DmaCallback;
+    Mcal_Dma_Init(&Dma);
+
+    return 1;
+    }
+
+/**
+ * @brief  Arms the DMA stream and starts continuous conversions.
+ * @return None
+ */
+void Mcal_Adc_Start(void)
+    {
+    Mcal_Dma_Start(ADC_DMA, ADC_DMA_STREAM, &ADC1->DR, Adc_Config->Buffer,
+	    (uint16_t) (Adc_Config->Frames * Adc_Config->Channel_Count));
+
+    Set(ADC1->CR2, ADC_CR2_ADON, 1);
+    for (volatile uint32_t i = 0; i < 100; i++); // Wait for tSTAB (3 us)
+    Set(ADC1->CR2, ADC_CR2_SWSTART, 1);
+    }
+
+/**
+ * @brief  Stops conversions and the DMA stream.
+ * @return None
+ */
+void Mcal_Adc_Stop(void)
+    {
+    Clear(ADC1->CR2, ADC_CR2_ADON, 1);
+    Mcal_Dma_Stop(ADC_DMA, ADC_DMA_STREAM);
+    }
+
+/**
+ * @brief  Returns the number of recovered overruns.
+ * @return Overrun count.
+ */
+uint32_t Mcal_Adc_Overruns(void)
+    {
+    return Adc_Overruns;
+    }
+
+/**
+ * @brief  Returns the number of recovered DMA transfer errors.
+ * @return DMA error count.
+ */
+uint32_t Mcal_Adc_DmaErrors(void)
+    {
+    return Adc_Dma_Errors;
+    }
+
+/**
+ * @brief  ADC interrupt: on overrun the DMA stops requesting, so restart the
+ *         stream from the start of the buffer to keep frames aligned.
+ * @return None
+ */
+void ADC_IRQHandler(void)
+    {
+    if (Read(ADC1->SR, ADC_SR_OVR))
+	{
+	Adc_Overruns++;
+	Adc_Restart();
+	}
+    }
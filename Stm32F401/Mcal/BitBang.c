@@ -0,0 +1,359 @@
+/*
+ * BitBang.c
+ *
+ *  Created on: Sep 16, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/BitBang.h"
+#include "../Lib/Inc/Atomic.h"
+
+/**
+ * @brief  Starts the DWT cycle counter.
+ * @return None
+ */
+void Mcal_BitBang_Init(void)
+    {
+    Set(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA, 1);
+    Set(DWT->CTRL, DWT_CTRL_CYCCNTENA, 1);
+    }
+
+/**
+ * @brief  Configures a pin as a fast output and precomputes its BSRR words.
+ * @param  Pin: Descriptor to fill.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @param  Pin_Number: Index of the pin.
+ * @param  Output_mode: Push_Pull or Open_Drain.
+ * @return None
+ */
+void Mcal_BitBang_Pin_Init(BitBang_Pin_t *Pin, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Output_mode_t Output_mode)
+    {
+    Pin_t Config = {0};
+
+    Pin->Port = GPIOx;
+    Pin->Set = 1UL << Pin_Number;
+    Pin->Reset = 1UL << (Pin_Number + 16);
+    Pin->Mask = 1UL << Pin_Number;
+
+    // Claim the pin as an input first: that turns the port clock on, so the
+    // idle level written next is not lost
+    Config.Pin_Number = Pin_Number;
+    Config.Functionality = Input;
+    Config.Output_mode = Output_mode;
+    Config.Speed = Very_High_Speed;
+    Config.Pulling_State = (Output_mode == Open_Drain) ? Pull_Up : No_Pulling;
+    Mcal_Gpio_Init(GPIOx, &Config);
+
+    // Preset the idle level before the pin becomes an output: open-drain lines
+    // idle released (high), push-pull lines such as SPI SCK (CPOL 0) idle low
+    GPIOx->BSRR = (Output_mode == Open_Drain) ? Pin->Set : Pin->Reset;
+
+    Config.Functionality = Output;
+    Mcal_Gpio_Init(GPIOx, &Config);
+    }
+
+/**
+ * @brief  Configures a pin as an input and fills its descriptor.
+ * @param  Pin: Descriptor to fill.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @param  Pin_Number: Index of the pin.
+ * @param  Pulling_State: Pull-up/pull-down configuration.
+ * @return None
+ */
+void Mcal_BitBang_Input_Init(BitBang_Pin_t *Pin, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Pulling_t Pulling_State)
+    {
+    Pin_t Config = {0};
+
+    Pin->Port = GPIOx;
+    Pin->Set = 1UL << Pin_Number;
+    Pin->Reset = 1UL << (Pin_Number + 16);
+    Pin->Mask = 1UL << Pin_Number;
+
+    Config.Pin_Number = Pin_Number;
+    Config.Functionality = Input;
+    Config.Pulling_State = Pulling_State;
+    Mcal_Gpio_Init(GPIOx, &Config);
+    }
+
+/**
+ * @brief  Sends WS2812 data. Interrupts are masked only while the pin is high,
+ *         where an extra delay would turn a 0 bit into a 1; an interrupt in the
+ *         low phase merely stretches the bit, which the strip tolerates as long
+ *         as it stays below the reset time.
+ * @param  Pin: Data pin.
+ * @param  Data: Pixel bytes in G, R, B order.
+ * @param  Length: Number of bytes.
+ * @return 1 on success, 0 if the core clock is too slow for WS2812 timing.
+ */
+uint8_t Mcal_BitBang_Ws2812_Send(const BitBang_Pin_t *Pin, const uint8_t *Data, uint32_t Length)
+    {
+    volatile uint32_t *Bsrr = &Pin->Port->BSRR;
+    const uint32_t Set_Word = Pin->Set;
+    const uint32_t Reset_Word = Pin->Reset;
+    const uint32_t T0h = BITBANG_NS_TO_CYCLES(BITBANG_WS2812_T0H_NS);
+    const uint32_t T1h = BITBANG_NS_TO_CYCLES(BITBANG_WS2812_T1H_NS);
+    const uint32_t Period = BITBANG_NS_TO_CYCLES(BITBANG_WS2812_PERIOD_NS);
+
+    if (CORE_CLOCK_HZ < BITBANG_WS2812_MIN_CLOCK_HZ)
+	{
+	return 0;
+	}
+
+    while (Length--)
+	{
+	uint8_t Byte = *Data++;
+
+	for (uint8_t Mask = 0x80; Mask; Mask >>= 1)
+	    {
+	    uint32_t High_Time = (Byte & Mask) ? T1h : T0h;
+	    uint32_t Primask = Atomic_IrqSave();
+	    uint32_t Start = DWT->CYCCNT;
+
+	    *Bsrr = Set_Word;
+	    BitBang_WaitFrom(Start, High_Time);
+	    *Bsrr = Reset_Word;
+
+	    Atomic_IrqRestore(Primask);
+	    BitBang_WaitFrom(Start, Period);
+	    }
+	}
+
+    //---------------------------------------------------------//
+
+    // Hold the line low so the strip latches the new colours
+    BitBang_Delay(BITBANG_US_TO_CYCLES(BITBANG_WS2812_RESET_US));
+    return 1;
+    }
+
+/**
+ * @brief  Issues a 1-Wire reset pulse and samples the presence pulse.
+ * @param  Pin: Bus pin.
+ * @return 1 if a device is present, 0 otherwise.
+ */
+uint8_t Mcal_BitBang_OneWire_Reset(const BitBang_Pin_t *Pin)
+    {
+    uint32_t Start;
+    uint32_t Primask;
+    uint8_t Present;
+
+    // The reset low time only has a lower bound, so it may be interrupted
+    BitBang_Low(Pin);
+    BitBang_Delay(BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_RESET_US));
+
+    Primask = Atomic_IrqSave();
+    Start = DWT->CYCCNT;
+    BitBang_High(Pin);
+    BitBang_WaitFrom(Start, BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_PRESENCE_US));
+    Present = (BitBang_Read(Pin) == 0);
+    Atomic_IrqRestore(Primask);
+
+    // Let the presence pulse finish before the first slot
+    BitBang_WaitFrom(Start, BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_RESET_US));
+    return Present;
+    }
+
+/**
+ * @brief  Runs one 1-Wire time slot; a read slot is a write-1 slot plus a sample.
+ * @param  Pin: Bus pin.
+ * @param  Bit: Bit to write (1 for read slots).
+ * @return Sampled bus level.
+ */
+static uint8_t BitBang_OneWire_Slot(const BitBang_Pin_t *Pin, uint8_t Bit)
+    {
+    uint32_t Low_Time = Bit ? BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_WRITE1_US)
+	    : BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_WRITE0_US);
+    uint32_t Primask = Atomic_IrqSave();
+    uint32_t Start = DWT->CYCCNT;
+    uint8_t Level;
+
+    BitBang_Low(Pin);
+    BitBang_WaitFrom(Start, Low_Time);
+    BitBang_High(Pin);
+    BitBang_WaitFrom(Start, BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_SAMPLE_US));
+    Level = (BitBang_Read(Pin) != 0);
+    Atomic_IrqRestore(Primask);
+
+    // Recovery time is not critical and runs with interrupts enabled
+    BitBang_WaitFrom(Start, BITBANG_US_TO_CYCLES(BITBANG_ONEWIRE_SLOT_US));
+    return Level;
+    }
+
+/**
+ * @brief  Writes one byte on the 1-Wire bus, LSB first.
+ * @param  Pin: Bus pin.
+ * @param  Data: Byte to write.
+ * @return None
+ */
+void Mcal_BitBang_OneWire_WriteByte(const BitBang_Pin_t *Pin, uint8_t Data)
+    {
+    for (uint8_t i = 0; i < 8; i++)
+	{
+	(void) BitBang_OneWire_Slot(Pin, Data & 0x01);
+	Data >>= 1;
+	}
+    }
+
+/**
+ * @brief  Reads one byte from the 1-Wire bus, LSB first.
+ * @param  Pin: Bus pin.
+ * @return Byte read.
+ */
+uint8_t Mcal_BitBang_OneWire_ReadByte(const BitBang_Pin_t *Pin)
+    {
+    uint8_t Data = 0;
+
+    for (uint8_t i = 0; i < 8; i++)
+	{
+	Data >>= 1;
+	if (BitBang_OneWire_Slot(Pin, 1))
+	    {
+	    Data |= 0x80;
+	    }
+	}
+    return Data;
+    }
+
+/**
+ * @brief  Exchanges one byte in SPI mode 0, MSB first. The bus is clocked by
+ *         the master, so no interrupt masking is needed.
+ * @param  Bus: SPI bus descriptor.
+ * @param  Data: Byte to send.
+ * @return Byte received.
+ */
+uint8_t Mcal_BitBang_Spi_Transfer(const BitBang_Spi_t *Bus, uint8_t Data)
+    {
+    uint8_t Received = 0;
+    uint32_t Edge = DWT->CYCCNT;
+
+    // Each wait is measured from the previous SCK edge as it actually happened,
+    // so an interrupt only stretches the phase it lands in instead of
+    // shortening the ones after it
+    for (uint8_t Mask = 0x80; Mask; Mask >>= 1)
+	{
+	Bus->Mosi.Port->BSRR = (Data & Mask) ? Bus->Mosi.Set : Bus->Mosi.Reset;
+	BitBang_WaitFrom(Edge, Bus->Half_Period);
+
+	BitBang_High(&Bus->Sck);
+	Edge = DWT->CYCCNT;
+	if (BitBang_Read(&Bus->Miso))
+	    {
+	    Received |= Mask;
+	    }
+	BitBang_WaitFrom(Edge, Bus->Half_Period);
+
+	BitBang_Low(&Bus->Sck);
+	Edge = DWT->CYCCNT;
+	}
+    return Received;
+    }
+
+/**
+ * @brief  Releases SCL and waits for any clock stretching to end.
+ * @param  Bus: I2C bus descriptor.
+ * @return 1 once SCL is high, 0 on timeout.
+ */
+static uint8_t BitBang_I2c_SclHigh(const BitBang_I2c_t *Bus)
+    {
+    uint32_t Start = DWT->CYCCNT;
+
+    BitBang_High(&Bus->Scl);
+    while (!BitBang_Read(&Bus->Scl))
+	{
+	if ((DWT->CYCCNT - Start) >= Bus->Stretch_Timeout)
+	    {
+	    return 0;
+	    }
+	}
+    return 1;
+    }
+
+/**
+ * @brief  Clocks one bit out on the I2C bus and samples SDA while SCL is high.
+ * @param  Bus: I2C bus descriptor.
+ * @param  Bit: Bit to send (1 releases SDA).
+ * @return Sampled SDA level, or 1 on clock-stretch timeout.
+ */
+static uint8_t BitBang_I2c_Bit(const BitBang_I2c_t *Bus, uint8_t Bit)
+    {
+    uint8_t Level = 1;
+
+    Bus->Sda.Port->BSRR = Bit ? Bus->Sda.Set : Bus->Sda.Reset;
+    BitBang_Delay(Bus->Half_Period);
+    if (BitBang_I2c_SclHigh(Bus))
+	{
+	Level = (BitBang_Read(&Bus->Sda) != 0);
+	}
+    BitBang_Delay(Bus->Half_Period);
+    BitBang_Low(&Bus->Scl);
+    return Level;
+    }
+
+/**
+ * @brief  Generates a start or repeated start condition.
+ * @param  Bus: I2C bus descriptor.
+ * @return None
+ */
+void Mcal_BitBang_I2c_Start(const BitBang_I2c_t *Bus)
+    {
+    BitBang_High(&Bus->Sda);
+    BitBang_Delay(Bus->Half_Period);
+    (void) BitBang_I2c_SclHigh(Bus);
+    BitBang_Delay(Bus->Half_Period);
+    BitBang_Low(&Bus->Sda);
+    BitBang_Delay(Bus->Half_Period);
+    BitBang_Low(&Bus->Scl);
+    }
+
+/**
+ * @brief  Generates a stop condition.
+ * @param  Bus: I2C bus descriptor.
+ * @return None
+ */
+void Mcal_BitBang_I2c_Stop(const BitBang_I2c_t *Bus)
+    {
+    BitBang_Low(&Bus->Sda);
+    BitBang_Delay(Bus->Half_Period);
+    (void) BitBang_I2c_SclHigh(Bus);
+    BitBang_Delay(Bus->Half_Period);
+    BitBang_High(&Bus->Sda);
+    BitBang_Delay(Bus->Half_Period);
+    }
+
+/**
+ * @brief  Writes one byte MSB first and reads the acknowledge bit.
+ * @param  Bus: I2C bus descriptor.
+ * @param  Data: Byte to write.
+ * @return 1 on ACK, 0 on NACK.
+ */
+uint8_t Mcal_BitBang_I2c_WriteByte(const BitBang_I2c_t *Bus, uint8_t Data)
+    {
+    for (uint8_t Mask = 0x80; Mask; Mask >>= 1)
+	{
+	(void) BitBang_I2c_Bit(Bus, (Data & Mask) != 0);
+	}
+
+    // The target acknowledges by pulling SDA low during the ninth clock
+    return BitBang_I2c_Bit(Bus, 1) == 0;
+    }
+
+/**
+ * @brief  Reads one byte MSB first and sends ACK or NACK.
+ * @param  Bus: I2C bus descriptor.
+ * @param  Ack: 1 to acknowledge, 0 for the last byte of a read.
+ * @return Byte read.
+ */
+uint8_t Mcal_BitBang_I2c_ReadByte(const BitBang_I2c_t *Bus, uint8_t Ack)
+    {
+    uint8_t Data = 0;
+
+    for (uint8_t i = 0; i < 8; i++)
+	{
+	Data = (uint8_t) ((Data << 1) | BitBang_I2c_Bit(Bus, 1));
+	}
+
+    (void) BitBang_I2c_Bit(Bus, !Ack);
+    BitBang_High(&Bus->Sda);
+    return Data;
+    }
@@ -0,0 +1,196 @@
+/*
+ * DMA.c
+ *
+ *  Created on: Sep 23, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/DMA.h"
+#include <stddef.h>
+
+/**
+ * @brief Bit offset of each stream's flag group in LISR/HISR (and the clear registers).
+ */
+static const uint8_t Dma_Flag_Shift[4] = {0, 6, 16, 22};
+
+/**
+ * @brief Interrupt number of every stream, indexed [controller][stream].
+ */
+static const uint8_t Dma_Irq[2][8] =
+    {
+	{DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+	 DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn},
+	{DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+	 DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn}
+    };
+
+/**
+ * @brief Registered callbacks and contexts, indexed [controller][stream].
+ */
+static Dma_Callback_t Dma_Callbacks[2][8];
+static void *Dma_Contexts[2][8];
+
+/**
+ * @brief  Clears every flag of a stream.
+ * @param  Controller: DMA1 or DMA2.
+ * @param  Stream: Stream number.
+ * @return None
+ */
+static void Dma_ClearFlags(DMA_TypeDef *Controller, uint8_t Stream)
+    {
+    uint32_t Mask = 0x3DUL << Dma_Flag_Shift[Stream & 3];
+
+    // Flag clear registers are write-one, so no read-modify-write is needed
+    if (Stream < 4)
+	{
+	Controller->LIFCR = Mask;
+	}
+    else
+	{
+	Controller->HIFCR = Mask;
+	}
+    }
+
+/**
+ * @brief  Configures a DMA stream and enables its interrupt in the NVIC.
+ * @param  Config: Stream configuration.
+ * @return None
+ */
+void Mcal_Dma_Init(const Dma_Config_t *Config)
+    {
+    uint8_t Index = (Config->Controller == DMA2);
+    DMA_Stream_TypeDef *Stream = &Config->Controller->STREAM[Config->Stream];
+    uint32_t Cr = 0;
+
+    // Enable the controller clock
+    Set(RCC->AHB1ENR, Index ? RCC_AHB1_DMA2 : RCC_AHB1_DMA1, 1);
+
+    Mcal_Dma_Stop(Config->Controller, Config->Stream);
+
+    //---------------------------------------------------------//
+
+    // Build the whole CR value and write it once
+    Set(Cr, DMA_SxCR_CHSEL, Config->Channel & 0x7);
+    Set(Cr, DMA_SxCR_PL, Config->Priority);
+    Set(Cr, DMA_SxCR_MSIZE, Config->Memory_Size);
+    Set(Cr, DMA_SxCR_PSIZE, Config->Peripheral_Size);
+    Set(Cr, DMA_SxCR_MINC, Config->Memory_Increment ? 1 : 0);
+    Set(Cr, DMA_SxCR_CIRC, Config->Circular ? 1 : 0);
+    Set(Cr, DMA_SxCR_DIR, Config->Direction);
+    Set(Cr, DMA_SxCR_TEIE, 1);
+    if (Config->Callback != NULL)
+	{
+	Set(Cr, DMA_SxCR_TCIE, 1);
+	Set(Cr, DMA_SxCR_HTIE, Config->Circular ? 1 : 0);
+	}
+    Stream->CR = Cr;
+
+    // Direct mode (FIFO disabled)
+    Stream->FCR = 0;
+
+    //---------------------------------------------------------//
+
+    Dma_Callbacks[Index][Config->Stream] = Config->Callback;
+    Dma_Contexts[Index][Config->Stream] = Config->Context;
+    NVIC_Enable(Dma_Irq[Index][Config->Stream]);
+    }
+
+/**
+ * @brief  Starts a transfer on a configured stream.
+ * @param  Controller: DMA1 or DMA2.
+ * @param  Stream: Stream number.
+ * @param  Peripheral: Peripheral register address.
+ * @param  Memory: Memory buffer address.
+ * @param  Count: Number of data items.
+ * @return None
+ */
+void Mcal_Dma_Start(DMA_TypeDef *Controller, uint8_t Stream, volatile void *Peripheral,
+	void *Memory, uint16_t Count)
+    {
+    DMA_Stream_TypeDef *Registers = &Controller->STREAM[Stream];
+
+    Dma_ClearFlags(Controller, Stream);
+    Registers->PAR = (uint32_t) (uintptr_t) Peripheral;
+    Registers->M0AR = (uint32_t) (uintptr_t) Memory;
+    Registers->NDTR = Count;
+    Set(Registers->CR, DMA_SxCR_EN, 1);
+    }
+
+/**
+ * @brief  Stops a stream; the hardware finishes the current beat before EN reads 0.
+ * @param  Controller: DMA1 or DMA2.
+ * @param  Stream: Stream number.
+ * @return None
+ */
+void Mcal_Dma_Stop(DMA_TypeDef *Controller, uint8_t Stream)
+    {
+    DMA_Stream_TypeDef *Registers = &Controller->STREAM[Stream];
+
+    Clear(Registers->CR, DMA_SxCR_EN, 1);
+    while (Read(Registers->CR, DMA_SxCR_EN))
+	{
+	}
+    Dma_ClearFlags(Controller, Stream);
+    }
+
+/**
+ * @brief  Returns the number of data items left in the current transfer.
+ * @param  Controller: DMA1 or DMA2.
+ * @param  Stream: Stream number.
+ * @return Remaining item count.
+ */
+uint16_t Mcal_Dma_Remaining(DMA_TypeDef *Controller, uint8_t Stream)
+    {
+    return (uint16_t) Controller->STREAM[Stream].NDTR;
+    }
+
+/**
+ * @brief  Common stream interrupt handler: clears the flags and reports events.
+ * @param  Controller: DMA1 or DMA2.
+ * @param  Stream: Stream number.
+ * @return None
+ */
+static void Dma_IrqHandler(DMA_TypeDef *Controller, uint8_t Stream)
+    {
+    uint8_t Index = (Controller == DMA2);
+    uint8_t Shift = Dma_Flag_Shift[Stream & 3];
+    uint32_t Flags = ((Stream < 4) ? Controller->LISR : Controller->HISR) >> Shift;
+    Dma_Callback_t Callback = Dma_Callbacks[Index][Stream];
+    void *Context = Dma_Contexts[Index][Stream];
+
+    Dma_ClearFlags(Controller, Stream);
+
+    if (Callback == NULL)
+	{
+	return;
+	}
+    if (Flags & ((1UL << DMA_FLAG_TEIF) | (1UL << DMA_FLAG_DMEIF)))
+	{
+	Callback(Dma_Transfer_Error, Context);
+	}
+    if (Flags & (1UL << DMA_FLAG_HTIF))
+	{
+	Callback(Dma_Half_Transfer, Context);
+	}
+    if (Flags & (1UL << DMA_FLAG_TCIF))
+	{
+	Callback(Dma_Transfer_Complete, Context);
+	}
+    }
+
+void DMA1_Stream0_IRQHandler(void) { Dma_IrqHandler(DMA1, 0); }
+void DMA1_Stream1_IRQHandler(void) { Dma_IrqHandler(DMA1, 1); }
+void DMA1_Stream2_IRQHandler(void) { Dma_IrqHandler(DMA1, 2); }
+void DMA1_Stream3_IRQHandler(void) { Dma_IrqHandler(DMA1, 3); }
+void DMA1_Stream4_IRQHandler(void) { Dma_IrqHandler(DMA1, 4); }
+void DMA1_Stream5_IRQHandler(void) { Dma_IrqHandler(DMA1, 5); }
+void DMA1_Stream6_IRQHandler(void) { Dma_IrqHandler(DMA1, 6); }
+void DMA1_Stream7_IRQHandler(void) { Dma_IrqHandler(DMA1, 7); }
+void DMA2_Stream0_IRQHandler(void) { Dma_IrqHandler(DMA2, 0); }
+void DMA2_Stream1_IRQHandler(void) { Dma_IrqHandler(DMA2, 1); }
+void DMA2_Stream2_IRQHandler(void) { Dma_IrqHandler(DMA2, 2); }
+void DMA2_Stream3_IRQHandler(void) { Dma_IrqHandler(DMA2, 3); }
+void DMA2_Stream4_IRQHandler(void) { Dma_IrqHandler(DMA2, 4); }
+void DMA2_Stream5_IRQHandler(void) { Dma_IrqHandler(DMA2, 5); }
+void DMA2_Stream6_IRQHandler(void) { Dma_IrqHandler(DMA2, 6); }
+void DMA2_Stream7_IRQHandler(void) { Dma_IrqHandler(DMA2, 7); }
@@ -0,0 +1,127 @@
+/*
+ * EXTI.c
+ *
+ *  Created on: Sep 30, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/EXTI.h"
+#include <stddef.h>
+
+/**
+ * @brief Registered callbacks and contexts, one per line.
+ */
+static Exti_Callback_t Exti_Callbacks[16];
+static void *Exti_Contexts[16];
+
+/**
+ * @brief  Returns the NVIC interrupt number serving an EXTI line.
+ * @param  Line: EXTI line 0 to 15.
+ * @return Interrupt number.
+ */
+static uint8_t Exti_Irq(Pin_index_t Line)
+    {
+    if (Line <= PIN_4)
+	{
+	return EXTI0_IRQn + Line;
+	}
+    else if (Line <= PIN_9)
+	{
+	return EXTI9_5_IRQn;
+	}
+    return EXTI15_10_IRQn;
+    }
+
+/**
+ * @brief  Routes a pin to its EXTI line, selects the edges and registers a callback.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @param  Pin_Number: Index of the pin.
+ * @param  Edge: Trigger edge(s).
+ * @param  Callback: Line callback.
+ * @param  Context: Passed to Callback.
+ * @return None
+ */
+void Mcal_Exti_Init(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number, Exti_Edge_t Edge,
+	Exti_Callback_t Callback, void *Context)
+    {
+    // The port table index doubles as the EXTICR port code
+    uint32_t Port = GPIO_PORT_INDEX(GPIOx);
+
+    Mcal_Exti_Disable(1U << Pin_Number);
+    Exti_Callbacks[Pin_Number] = Callback;
+    Exti_Contexts[Pin_Number] = Context;
+
+    //---------------------------------------------------------//
+
+    // Select the port driving this line
+    Set(RCC->APB2ENR, RCC_APB2_SYSCFG, 1);
+    Clear(SYSCFG->EXTICR[Pin_Number / 4], (Pin_Number % 4) * 4, 0b1111);
+    Set(SYSCFG->EXTICR[Pin_Number / 4], (Pin_Number % 4) * 4, Port);
+
+    // Configure the trigger edges
+    Clear(EXTI->RTSR, Pin_Number, 1);
+    Clear(EXTI->FTSR, Pin_Number, 1);
+    if (Edge & Exti_Rising)
+	{
+	Set(EXTI->RTSR, Pin_Number, 1);
+	}
+    if (Edge & Exti_Falling)
+	{
+	Set(EXTI->FTSR, Pin_Number, 1);
+	}
+
+    NVIC_Enable(Exti_Irq(Pin_Number));
+    }
+
+/**
+ * @brief  Clears stale pending flags and unmasks lines.
+ * @param  Lines: Bitmask of EXTI lines.
+ * @return None
+ */
+void Mcal_Exti_Enable(uint16_t Lines)
+    {
+    EXTI->PR = Lines;
+    Set(EXTI->IMR, 0, Lines);
+    }
+
+/**
+ * @brief  Masks lines.
+ * @param  Lines: Bitmask of EXTI lines.
+ * @return None
+ */
+void Mcal_Exti_Disable(uint16_t Lines)
+    {
+    Clear(EXTI->IMR, 0, Lines);
+    }
+
+/**
+ * @brief  Services every pending, unmasked line in a range.
+ * @param  First: First line handled by the vector.
+ * @param  Last: Last line handled by the vector.
+ * @return None
+ */
+static void Exti_IrqHandler(Pin_index_t First, Pin_index_t Last)
+    {
+    uint32_t Pending = EXTI->PR & EXTI->IMR;
+
+    for (uint8_t Line = First; Line <= Last; Line++)
+	{
+	if (Pending & (1UL << Line))
+	    {
+	    // PR is write-one-to-clear; clear before the callback so a new edge is not lost
+	    EXTI->PR = 1UL << Line;
+	    if (Exti_Callbacks[Line] != NULL)
+		{
+		Exti_Callbacks[Line]((Pin_index_t) Line, Exti_Contexts[Line]);
+		}
+	    }
+	}
+    }
+
+void EXTI0_IRQHandler(void) { Exti_IrqHandler(PIN_0, PIN_0); }
+void EXTI1_IRQHandler(void) { Exti_IrqHandler(PIN_1, PIN_1); }
+void EXTI2_IRQHandler(void) { Exti_IrqHandler(PIN_2, PIN_2); }
+void EXTI3_IRQHandler(void) { Exti_IrqHandler(PIN_3, PIN_3); }
+void EXTI4_IRQHandler(void) { Exti_IrqHandler(PIN_4, PIN_4); }
+void EXTI9_5_IRQHandler(void) { Exti_IrqHandler(PIN_5, PIN_9); }
+void EXTI15_10_IRQHandler(void) { Exti_IrqHandler(PIN_10, PIN_15); }
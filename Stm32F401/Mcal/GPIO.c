@@ -6,6 +6,100 @@
  */
 
 #include "../Inc/GPIO.h"
+#include "../Inc/Trace.h"
+#include "../Lib/Inc/Atomic.h"
+#include <stddef.h>
+
+/**
+ * @brief Packs a port and pin into one trace argument (ports are 1 KB aligned).
+ */
+#define GPIO_TRACE_ARG(GPIOx, Pin) ((uint32_t) (uintptr_t) (GPIOx) | (uint32_t) (Pin))
+
+/**
+ * @brief Structure describing a GPIO port.
+ */
+typedef struct
+{
+    GPIO_TypeDef *Registers; /*!< Register block, NULL for unimplemented ports */
+    uint8_t Clock_Bit; /*!< Bit in AHB1ENR, AHB1LPENR and AHB1RSTR */
+} Gpio_Port_t;
+
+/**
+ * @brief Port table, indexed by GPIO_PORT_INDEX.
+ */
+static const Gpio_Port_t Gpio_Ports[GPIO_PORT_COUNT] =
+    {
+	{GPIOA, RCC_AHB1_GPIOA},
+	{GPIOB, RCC_AHB1_GPIOB},
+	{GPIOC, RCC_AHB1_GPIOC},
+	{GPIOD, RCC_AHB1_GPIOD},
+	{GPIOE, RCC_AHB1_GPIOE},
+	{NULL, 0},
+	{NULL, 0},
+	{GPIOH, RCC_AHB1_GPIOH}
+    };
+
+/**
+ * @brief Claimed pins and number of claimed pins of every port.
+ */
+static uint16_t Gpio_Claimed[GPIO_PORT_COUNT];
+static uint8_t Gpio_Users[GPIO_PORT_COUNT];
+
+/**
+ * @brief  Looks a port up in the port table.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @return Port descriptor, or NULL if GPIOx is not a GPIO port.
+ */
+static const Gpio_Port_t *Gpio_Port(GPIO_TypeDef *GPIOx)
+    {
+    uint32_t Index = GPIO_PORT_INDEX(GPIOx);
+
+    if ((Index >= GPIO_PORT_COUNT) || (Gpio_Ports[Index].Registers != GPIOx))
+	{
+	return NULL;
+	}
+    return &Gpio_Ports[Index];
+    }
+
+/**
+ * @brief  Claims a pin; the first claim on a port enables its clock.
+ * @param  Port: Port descriptor.
+ * @param  Pin_Number: Index of the pin.
+ * @return None
+ */
+static void Gpio_Claim(const Gpio_Port_t *Port, Pin_index_t Pin_Number)
+    {
+    uint32_t Index = (uint32_t) (Port - Gpio_Ports);
+    uint16_t Mask = (uint16_t) (1U << Pin_Number);
+    uint32_t Primask = Atomic_IrqSave();
+
+    // Reconfiguring an already claimed pin does not take another reference
+    if (!(Gpio_Claimed[Index] & Mask))
+	{
+	Gpio_Claimed[Index] |= Mask;
+	if (Gpio_Users[Index]++ == 0)
+	    {
+	    Set(RCC->AHB1ENR, Port->Clock_Bit, 1);
+	    Set(RCC->AHB1LPENR, Port->Clock_Bit, 1);
+
+	    // Read back so the clock is running before the first register access
+	    (void) RCC->AHB1ENR;
+	    }
+	}
+
+    Atomic_IrqRestore(Primask);
+    }
+
+/**
+ * @brief  Gates a port clock off in run and sleep mode.
+ * @param  Port: Port descriptor.
+ * @return None
+ */
+static void Gpio_GateClock(const Gpio_Port_t *Port)
+    {
+    Clear(RCC->AHB1ENR, Port->Clock_Bit, 1);
+    Clear(RCC->AHB1LPENR, Port->Clock_Bit, 1);
+    }
 
 /**
  * @brief  Initializes a specific GPIO pin with the provided configuration.
@@ -15,9 +109,15 @@
  */
 void Mcal_Gpio_Init(GPIO_TypeDef *GPIOx, Pin_t *Pin)
     {
-    // Clear the pin mode bits and set the new mode
-    Clear(GPIOx->MODER, Pin->Pin_Number * 2, 0b11);
-    Set(GPIOx->MODER, Pin->Pin_Number * 2, Pin->Functionality);
+    TRACE_ENTER(TRACE_ID_GPIO_INIT, GPIO_TRACE_ARG(GPIOx, Pin->Pin_Number));
+
+    const Gpio_Port_t *Port = Gpio_Port(GPIOx);
+    if (Port == NULL)
+	{
+	TRACE_EXIT(TRACE_ID_GPIO_INIT, GPIO_TRACE_ARG(GPIOx, Pin->Pin_Number));
+	return;
+	}
+    Gpio_Claim(Port, Pin->Pin_Number);
 
     //---------------------------------------------------------//
 
@@ -52,15 +152,61 @@ void Mcal_Gpio_Init(GPIO_TypeDef *GPIOx, Pin_t *Pin)
 	    {
 	    // Configure alternate function for pin numbers 0-7
 	    Clear(GPIOx->AFR[0], Pin->Pin_Number * 4, 0b1111);
-	    Set(GPIOx->AFR[0], Pin->Pin_Number * 4, Pin->Pin_Number);
+	    Set(GPIOx->AFR[0], Pin->Pin_Number * 4, Pin->Alternate_Function & 0b1111);
 	    }
 	else if (Pin->Pin_Number <= PIN_15)
 	    {
 	    // Configure alternate function for pin numbers 8-15
-	    Clear(GPIOx->AFR[1], Pin->Pin_Number * 4, 0b1111);
-	    Set(GPIOx->AFR[1], Pin->Pin_Number * 4, Pin->Pin_Number);
+	    Clear(GPIOx->AFR[1], (Pin->Pin_Number - PIN_8) * 4, 0b1111);
+	    Set(GPIOx->AFR[1], (Pin->Pin_Number - PIN_8) * 4, Pin->Alternate_Function & 0b1111);
+	    }
+	}
+
+    //--------------------------------------------------------//
+
+    // Switch the mode last, so the pin only starts driving once its output
+    // type, speed, pulls and alternate function are in place
+    Clear(GPIOx->MODER, Pin->Pin_Number * 2, 0b11);
+    Set(GPIOx->MODER, Pin->Pin_Number * 2, Pin->Functionality);
+
+    TRACE_EXIT(TRACE_ID_GPIO_INIT, GPIO_TRACE_ARG(GPIOx, Pin->Pin_Number));
+    }
+
+/**
+ * @brief  Releases a pin; the last release on a port gates its clock off.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @param  Pin_Number: Index of the pin to release.
+ * @return None
+ */
+void Mcal_Gpio_Release(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number)
+    {
+    TRACE_ENTER(TRACE_ID_GPIO_RELEASE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
+
+    const Gpio_Port_t *Port = Gpio_Port(GPIOx);
+    uint16_t Mask = (uint16_t) (1U << Pin_Number);
+
+    if (Port != NULL)
+	{
+	uint32_t Index = (uint32_t) (Port - Gpio_Ports);
+	uint32_t Primask = Atomic_IrqSave();
+
+	if (Gpio_Claimed[Index] & Mask)
+	    {
+	    // Analog mode without pulls draws the least current while the pin is unused
+	    Set(GPIOx->MODER, Pin_Number * 2, 0b11);
+	    Clear(GPIOx->PUPDR, Pin_Number * 2, 0b11);
+
+	    Gpio_Claimed[Index] &= (uint16_t) ~Mask;
+	    if (--Gpio_Users[Index] == 0)
+		{
+		Gpio_GateClock(Port);
+		}
 	    }
+
+	Atomic_IrqRestore(Primask);
 	}
+
+    TRACE_EXIT(TRACE_ID_GPIO_RELEASE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
     }
 
 /**
@@ -70,19 +216,26 @@ void Mcal_Gpio_Init(GPIO_TypeDef *GPIOx, Pin_t *Pin)
  */
 void Mcal_Gpio_Deinit(GPIO_TypeDef *GPIOx)
     {
-    // Reset the specified GPIO peripheral
-    if (GPIOx == GPIOA)
-	{
-	RCC_GPIOA_Reset();
-	}
-    else if (GPIOx == GPIOB)
-	{
-	RCC_GPIOB_Reset();
-	}
-    else if (GPIOx == GPIOC)
+    TRACE_ENTER(TRACE_ID_GPIO_DEINIT, GPIO_TRACE_ARG(GPIOx, 0));
+
+    const Gpio_Port_t *Port = Gpio_Port(GPIOx);
+
+    if (Port != NULL)
 	{
-	RCC_GPIOC_Reset();
+	uint32_t Index = (uint32_t) (Port - Gpio_Ports);
+	uint32_t Primask = Atomic_IrqSave();
+
+	// Pulse the port reset, then drop every claim and gate the clock
+	Set(RCC->AHB1RSTR, Port->Clock_Bit, 1);
+	Clear(RCC->AHB1RSTR, Port->Clock_Bit, 1);
+	Gpio_Claimed[Index] = 0;
+	Gpio_Users[Index] = 0;
+	Gpio_GateClock(Port);
+
+	Atomic_IrqRestore(Primask);
 	}
+
+    TRACE_EXIT(TRACE_ID_GPIO_DEINIT, GPIO_TRACE_ARG(GPIOx, 0));
     }
 
 /**
@@ -95,6 +248,8 @@ void Mcal_Gpio_Deinit(GPIO_TypeDef *GPIOx)
 void Mcal_Gpio_Write(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
 	Pin_Logic_Status_t Logic)
     {
+    TRACE_ENTER(TRACE_ID_GPIO_WRITE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
+
     // Set or clear the pin output level
     if (Logic == High)
 	{
@@ -104,6 +259,8 @@ void Mcal_Gpio_Write(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
 	{
 	Clear(GPIOx->ODR, Pin_Number, 1);
 	}
+
+    TRACE_EXIT(TRACE_ID_GPIO_WRITE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
     }
 
 /**
@@ -112,10 +269,15 @@ void Mcal_Gpio_Write(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
  * @param  Pin_Number: Index of the pin to read.
  * @return Logic level of the pin (0 or 1).
  */
-uint8_t Mcal_Gpio_Read(GPIO_TypeDef *GPIOx, uint8_t Pin_Number)
+uint8_t Mcal_Gpio_Read(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number)
     {
+    TRACE_ENTER(TRACE_ID_GPIO_READ, GPIO_TRACE_ARG(GPIOx, Pin_Number));
+
     // Return the current input data level of the pin
-    return Read(GPIOx->IDR, Pin_Number);
+    uint8_t Level = Read(GPIOx->IDR, Pin_Number);
+
+    TRACE_EXIT(TRACE_ID_GPIO_READ, GPIO_TRACE_ARG(GPIOx, Pin_Number));
+    return Level;
     }
 
 /**
@@ -126,6 +288,10 @@ uint8_t Mcal_Gpio_Read(GPIO_TypeDef *GPIOx, uint8_t Pin_Number)
  */
 void Mcal_Gpio_Toggle(GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number)
     {
+    TRACE_ENTER(TRACE_ID_GPIO_TOGGLE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
+
     // Toggle the output level of the pin
     Toggle(GPIOx->ODR, Pin_Number, 1);
+
+    TRACE_EXIT(TRACE_ID_GPIO_TOGGLE, GPIO_TRACE_ARG(GPIOx, Pin_Number));
     }
@@ -0,0 +1,308 @@
+/*
+ * PWM.c
+ *
+ *  Created on: Oct 9, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/PWM.h"
+#include <stddef.h>
+
+/**
+ * @brief Requested duty of every channel, kept to rescale compares on a frequency change.
+ */
+static uint16_t Pwm_Duty[Tim_Count][4];
+
+/**
+ * @brief  Checks whether a timer counts in a center-aligned mode.
+ * @param  TIMx: Timer registers.
+ * @return 1 if center-aligned, 0 if edge-aligned.
+ */
+static inline uint8_t Pwm_IsCenter(TIM_TypeDef *TIMx)
+    {
+    return Read(TIMx->CR1, TIM_CR1_CMS) || Read(TIMx->CR1, TIM_CR1_CMS + 1);
+    }
+
+/**
+ * @brief  Returns the duty scale of a timer: edge-aligned periods have ARR + 1
+ *         compare steps, center-aligned ones ARR.
+ * @param  TIMx: Timer registers.
+ * @return Period in compare steps.
+ */
+static inline uint32_t Pwm_StepCount(TIM_TypeDef *TIMx)
+    {
+    return Pwm_IsCenter(TIMx) ? TIMx->ARR : TIMx->ARR + 1;
+    }
+
+/**
+ * @brief  Computes the compare value of a duty cycle.
+ * @param  TIMx: Timer registers.
+ * @param  Duty: Duty cycle, 0 to PWM_DUTY_MAX.
+ * @return Compare value.
+ */
+static uint32_t Pwm_Compare(TIM_TypeDef *TIMx, uint16_t Duty)
+    {
+    // Full duty needs CCRx > ARR in either alignment
+    if (Duty >= PWM_DUTY_MAX)
+	{
+	return TIMx->ARR + 1;
+	}
+    return (uint32_t) (((uint64_t) Pwm_StepCount(TIMx) * Duty) / PWM_DUTY_MAX);
+    }
+
+/**
+ * @brief  Programs prescaler and auto-reload for a frequency.
+ * @param  Timer: Timer.
+ * @param  Frequency: PWM frequency in Hz.
+ * @return 1 on success, 0 if the frequency cannot be reached.
+ */
+static uint8_t Pwm_TimeBase(Tim_Id_t Timer, uint32_t Frequency)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+    uint32_t Ticks;
+    uint32_t Prescaler = 0;
+    uint8_t Center = Pwm_IsCenter(TIMx);
+
+    if (Frequency == 0)
+	{
+	return 0;
+	}
+
+    // An edge-aligned period is ARR + 1 ticks, a center-aligned one 2 * ARR
+    // (ARR ticks up, ARR ticks down)
+    Ticks = TIM_CLOCK_HZ / Frequency;
+    if (Center)
+	{
+	Ticks /= 2;
+	}
+
+    // Smallest prescaler that fits the period; 16-bit counters keep ARR + 1 <= 0xFFFF
+    // so that a 100% compare value still fits the register
+    if (!Descriptor->Wide)
+	{
+	Prescaler = (Ticks - 1) / (Center ? 0xFFFE : 0xFFFF);
+	}
+    if ((Ticks < 2) || (Prescaler > 0xFFFF))
+	{
+	return 0;
+	}
+
+    TIMx->PSC = Prescaler;
+    TIMx->ARR = Center ? Ticks / (Prescaler + 1) : Ticks / (Prescaler + 1) - 1;
+    return 1;
+    }
+
+/**
+ * @brief  Configures a timer as a PWM time base.
+ * @param  Timer: Timer.
+ * @param  Frequency: PWM frequency in Hz.
+ * @param  Align: Counter alignment.
+ * @return 1 on success, 0 if the frequency cannot be reached.
+ */
+uint8_t Mcal_Pwm_Init(Tim_Id_t Timer, uint32_t Frequency, Pwm_Align_t Align)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+
+    Mcal_Tim_Enable(Timer);
+
+    // Buffered ARR; center-aligned mode 1 (compare flags while counting down)
+    TIMx->CR1 = 1UL << TIM_CR1_ARPE;
+    if (Align == Pwm_Center_Aligned)
+	{
+	Set(TIMx->CR1, TIM_CR1_CMS, 0b01);
+	}
+    TIMx->SMCR = 0;
+    TIMx->DIER = 0;
+    TIMx->CCER = 0;
+    TIMx->CCMR[0] = 0;
+    TIMx->CCMR[1] = 0;
+    TIMx->CNT = 0;
+
+    for (uint8_t Channel = 0; Channel < Descriptor->Channels; Channel++)
+	{
+	Pwm_Duty[Timer][Channel] = 0;
+	TIMx->CCR[Channel] = 0;
+	}
+
+    return Pwm_TimeBase(Timer, Frequency);
+    }
+
+/**
+ * @brief  Enables PWM mode 1 on a channel.
+ * @param  Timer: Timer.
+ * @param  Channel: Channel.
+ * @param  Polarity: Output polarity.
+ * @return None
+ */
+void Mcal_Pwm_Channel_Init(Tim_Id_t Timer, Tim_Channel_t Channel, Pwm_Polarity_t Polarity)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+    uint8_t Mode_Shift = (Channel % 2) * 8;
+    uint8_t Enable_Shift = Channel * 4;
+
+    if (Channel >= Descriptor->Channels)
+	{
+	return;
+	}
+
+    // Output compare, PWM mode 1 (active while CNT < CCRx), compare preload on
+    Clear(TIMx->CCMR[Channel / 2], Mode_Shift, 0xFF);
+    Set(TIMx->CCMR[Channel / 2], Mode_Shift + TIM_CCMR_OCM, 0b110);
+    Set(TIMx->CCMR[Channel / 2], Mode_Shift + TIM_CCMR_OCPE, 1);
+
+    Clear(TIMx->CCER, Enable_Shift, 0b1111);
+    Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCP, Polarity);
+    Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCE, 1);
+    }
+
+/**
+ * @brief  Loads the preloaded registers and starts the counter.
+ * @param  Timer: Timer.
+ * @return None
+ */
+void Mcal_Pwm_Start(Tim_Id_t Timer)
+    {
+    TIM_TypeDef *TIMx = Mcal_Tim_Descriptor(Timer)->Registers;
+
+    // Transfer PSC, ARR and CCRx from their preload registers before the first period
+    TIMx->EGR = 1UL << TIM_EGR_UG;
+    TIMx->SR = 0;
+
+    // Advanced-control timers gate all outputs with MOE
+    if (Timer == Tim_1)
+	{
+	Set(TIMx->BDTR, TIM_BDTR_MOE, 1);
+	}
+    Set(TIMx->CR1, TIM_CR1_CEN, 1);
+    }
+
+/**
+ * @brief  Stops the counter.
+ * @param  Timer: Timer.
+ * @return None
+ */
+void Mcal_Pwm_Stop(Tim_Id_t Timer)
+    {
+    Clear(Mcal_Tim_Descriptor(Timer)->Registers->CR1, TIM_CR1_CEN, 1);
+    }
+
+/**
+ * @brief  Sets the duty cycle of a channel.
+ * @param  Timer: Timer.
+ * @param  Channel: Channel.
+ * @param  Duty: Duty cycle, 0 to PWM_DUTY_MAX.
+ * @return None
+ */
+void Mcal_Pwm_SetDuty(Tim_Id_t Timer, Tim_Channel_t Channel, uint16_t Duty)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+
+    if (Channel >= Descriptor->Channels)
+	{
+	return;
+	}
+    Pwm_Duty[Timer][Channel] = Duty;
+    TIMx->CCR[Channel] = Pwm_Compare(TIMx, Duty);
+    }
+
+/**
+ * @brief  Changes the frequency of a timer, keeping every channel's duty.
+ * @param  Timer: Timer.
+ * @param  Frequency: PWM frequency in Hz.
+ * @return 1 on success, 0 if the frequency cannot be reached.
+ */
+uint8_t Mcal_Pwm_SetFrequency(Tim_Id_t Timer, uint32_t Frequency)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+    uint8_t Status;
+
+    // Hold off update events so PSC, ARR and all CCRx switch in the same period
+    Set(TIMx->CR1, TIM_CR1_UDIS, 1);
+    Status = Pwm_TimeBase(Timer, Frequency);
+    if (Status)
+	{
+	for (uint8_t Channel = 0; Channel < Descriptor->Channels; Channel++)
+	    {
+	    TIMx->CCR[Channel] = Pwm_Compare(TIMx, Pwm_Duty[Timer][Channel]);
+	    }
+	}
+    Clear(TIMx->CR1, TIM_CR1_UDIS, 1);
+
+    return Status;
+    }
+
+/**
+ * @brief  Returns the number of compare steps in one period.
+ * @param  Timer: Timer.
+ * @return Period in compare steps.
+ */
+uint32_t Mcal_Pwm_Steps(Tim_Id_t Timer)
+    {
+    return Pwm_StepCount(Mcal_Tim_Descriptor(Timer)->Registers);
+    }
+
+/**
+ * @brief  Streams compare values into a channel on every update event.
+ * @param  Timer: Timer.
+ * @param  Channel: Channel.
+ * @param  Compares: Compare values.
+ * @param  Count: Number of values.
+ * @param  Circular: 1 to replay the buffer continuously.
+ * @param  Callback: Optional half/complete callback.
+ * @param  Context: Passed to Callback.
+ * @return 1 on success, 0 if the timer has no update DMA request.
+ */
+uint8_t Mcal_Pwm_Stream_Start(Tim_Id_t Timer, Tim_Channel_t Channel, const void *Compares,
+	uint16_t Count, uint8_t Circular, Dma_Callback_t Callback, void *Context)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+    const Tim_Dma_t *Request = &Descriptor->Update_Dma;
+
+    if ((Request->Controller == NULL) || (Channel >= Descriptor->Channels))
+	{
+	return 0;
+	}
+
+    // Each update request writes the CCRx preload, which the next update makes active
+    Dma_Config_t Dma = {0};
+    Dma.Controller = Request->Controller;
+    Dma.Stream = Request->Stream;
+    Dma.Channel = Request->Channel;
+    Dma.Direction = Dma_Memory_To_Peripheral;
+    Dma.Peripheral_Size = Descriptor->Wide ? Dma_Word : Dma_Half_Word;
+    Dma.Memory_Size = Dma.Peripheral_Size;
+    Dma.Memory_Increment = 1;
+    Dma.Circular = Circular;
+    Dma.Priority = Dma_Priority_High;
+    Dma.Callback = Callback;
+    Dma.Context = Context;
+    Mcal_Dma_Init(&Dma);
+
+    Mcal_Dma_Start(Request->Controller, Request->Stream, &Descriptor->Registers->CCR[Channel],
+	    (void *) Compares, Count);
+    Set(Descriptor->Registers->DIER, TIM_DIER_UDE, 1);
+
+    return 1;
+    }
+
+/**
+ * @brief  Stops duty streaming.
+ * @param  Timer: Timer.
+ * @return None
+ */
+void Mcal_Pwm_Stream_Stop(Tim_Id_t Timer)
+    {
+    const Tim_Descriptor_t *Descriptor = Mcal_Tim_Descriptor(Timer);
+
+    if (Descriptor->Update_Dma.Controller == NULL)
+	{
+	return;
+	}
+    Clear(Descriptor->Registers->DIER, TIM_DIER_UDE, 1);
+    Mcal_Dma_Stop(Descriptor->Update_Dma.Controller, Descriptor->Update_Dma.Stream);
+    }
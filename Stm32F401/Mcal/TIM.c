@@ -0,0 +1,336 @@
+/*
+ * TIM.c
+ *
+ *  Created on: Oct 7, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/TIM.h"
+#include <stddef.h>
+
+/**
+ * @brief Timer descriptor table, indexed by Tim_Id_t.
+ * DMA routing follows the DMA1/DMA2 request mapping tables of RM0368.
+ */
+static const Tim_Descriptor_t Tim_Descriptors[Tim_Count] =
+    {
+	[Tim_1] = {TIM1, &RCC->APB2ENR, RCC_APB2_TIM1, 1, 4, 0, TIM_CAP_SLAVE | TIM_CAP_ENCODER,
+		{{DMA2, 1, 6}, {DMA2, 2, 6}, {DMA2, 6, 6}, {DMA2, 4, 6}}, {DMA2, 5, 6}},
+	[Tim_2] = {TIM2, &RCC->APB1ENR, RCC_APB1_TIM2, 1, 4, 1, TIM_CAP_SLAVE | TIM_CAP_ENCODER,
+		{{DMA1, 5, 3}, {DMA1, 6, 3}, {DMA1, 1, 3}, {DMA1, 7, 3}}, {DMA1, 7, 3}},
+	[Tim_3] = {TIM3, &RCC->APB1ENR, RCC_APB1_TIM3, 2, 4, 0, TIM_CAP_SLAVE | TIM_CAP_ENCODER,
+		{{DMA1, 4, 5}, {DMA1, 5, 5}, {DMA1, 7, 5}, {DMA1, 2, 5}}, {DMA1, 2, 5}},
+	[Tim_4] = {TIM4, &RCC->APB1ENR, RCC_APB1_TIM4, 2, 4, 0, TIM_CAP_SLAVE | TIM_CAP_ENCODER,
+		{{DMA1, 0, 2}, {DMA1, 3, 2}, {DMA1, 7, 2}, {NULL, 0, 0}}, {DMA1, 6, 2}},
+	[Tim_5] = {TIM5, &RCC->APB1ENR, RCC_APB1_TIM5, 2, 4, 1, TIM_CAP_SLAVE | TIM_CAP_ENCODER,
+		{{DMA1, 2, 6}, {DMA1, 4, 6}, {DMA1, 0, 6}, {DMA1, 1, 6}}, {DMA1, 6, 6}},
+	[Tim_9] = {TIM9, &RCC->APB2ENR, RCC_APB2_TIM9, 3, 2, 0, TIM_CAP_SLAVE,
+		{{NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}}, {NULL, 0, 0}},
+	[Tim_10] = {TIM10, &RCC->APB2ENR, RCC_APB2_TIM10, 3, 1, 0, 0,
+		{{NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}}, {NULL, 0, 0}},
+	[Tim_11] = {TIM11, &RCC->APB2ENR, RCC_APB2_TIM11, 3, 1, 0, 0,
+		{{NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}}, {NULL, 0, 0}},
+    };
+
+/**
+ * @brief  Returns the descriptor of a timer.
+ * @param  Timer: Timer.
+ * @return Timer descriptor.
+ */
+const Tim_Descriptor_t *Mcal_Tim_Descriptor(Tim_Id_t Timer)
+    {
+    return &Tim_Descriptors[Timer];
+    }
+
+/**
+ * @brief  Enables the timer clock and stops the counter.
+ * @param  Timer: Timer.
+ * @return None
+ */
+void Mcal_Tim_Enable(Tim_Id_t Timer)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Timer];
+
+    Set(*Descriptor->Enable_Register, Descriptor->Enable_Bit, 1);
+    Clear(Descriptor->Registers->CR1, TIM_CR1_CEN, 1);
+    }
+
+/**
+ * @brief  Connects a pin to a timer through its alternate function.
+ * @param  Timer: Timer.
+ * @param  GPIOx: Pointer to the GPIO peripheral.
+ * @param  Pin_Number: Index of the pin.
+ * @param  Pulling_State: Pull-up/pull-down configuration.
+ * @return None
+ */
+void Mcal_Tim_Pin_Init(Tim_Id_t Timer, GPIO_TypeDef *GPIOx, Pin_index_t Pin_Number,
+	Pin_Pulling_t Pulling_State)
+    {
+    Pin_t Pin = {0};
+
+    Pin.Pin_Number = Pin_Number;
+    Pin.Functionality = Alternative;
+    Pin.Output_mode = Push_Pull;
+    Pin.Speed = High_Speed;
+    Pin.Pulling_State = Pulling_State;
+    Pin.Alternate_Function = Tim_Descriptors[Timer].Alternate_Function;
+    Mcal_Gpio_Init(GPIOx, &Pin);
+    }
+
+/**
+ * @brief  Configures a channel as an input.
+ * @param  TIMx: Timer registers.
+ * @param  Channel: Channel.
+ * @param  Source: CCxS selection (1 = own input, 2 = neighbour input).
+ * @param  Filter: Input filter.
+ * @param  Edge: Capture edge(s).
+ * @return None
+ */
+static void Tim_InputChannel(TIM_TypeDef *TIMx, Tim_Channel_t Channel, uint8_t Source,
+	uint8_t Filter, Tim_Edge_t Edge)
+    {
+    uint8_t Mode_Shift = (Channel % 2) * 8;
+    uint8_t Enable_Shift = Channel * 4;
+
+    // Input selection and filter, input prescaler left at 1
+    Clear(TIMx->CCMR[Channel / 2], Mode_Shift, 0xFF);
+    Set(TIMx->CCMR[Channel / 2], Mode_Shift + TIM_CCMR_CCS, Source & 0b11);
+    Set(TIMx->CCMR[Channel / 2], Mode_Shift + TIM_CCMR_ICF, Filter & 0b1111);
+
+    //---------------------------------------------------------//
+
+    // Polarity: CCxP alone selects falling, CCxP + CCxNP selects both edges
+    Clear(TIMx->CCER, Enable_Shift, 0b1111);
+    if (Edge == Tim_Falling)
+	{
+	Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCP, 1);
+	}
+    else if (Edge == Tim_Both_Edges)
+	{
+	Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCP, 1);
+	Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCNP, 1);
+	}
+    Set(TIMx->CCER, Enable_Shift + TIM_CCER_CCE, 1);
+    }
+
+/**
+ * @brief  Sets up a free-running counter with the given prescaler.
+ * @param  Timer: Timer.
+ * @param  Prescaler: Counter prescaler.
+ * @return None
+ */
+static void Tim_FreeRun(Tim_Id_t Timer, uint16_t Prescaler)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Timer];
+    TIM_TypeDef *TIMx = Descriptor->Registers;
+
+    Mcal_Tim_Enable(Timer);
+    TIMx->SMCR = 0;
+    TIMx->DIER = 0;
+    TIMx->PSC = Prescaler;
+    TIMx->ARR = Descriptor->Wide ? 0xFFFFFFFFUL : 0xFFFFUL;
+
+    // Load the prescaler now instead of at the first overflow
+    TIMx->EGR = 1UL << TIM_EGR_UG;
+    TIMx->SR = 0;
+    }
+
+/**
+ * @brief  Configures input capture with a DMA transfer per captured edge.
+ * @param  Config: Capture configuration.
+ * @return 1 on success, 0 if the channel has no DMA request or the buffer is unusable.
+ */
+uint8_t Mcal_Tim_Capture_Init(const Tim_Capture_Config_t *Config)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Config->Timer];
+    const Tim_Dma_t *Request = &Descriptor->Channel_Dma[Config->Channel];
+
+    // A period needs two timestamps in the buffer
+    if ((Request->Controller == NULL) || (Config->Channel >= Descriptor->Channels)
+	    || (Config->Buffer == NULL) || (Config->Count < 2))
+	{
+	return 0;
+	}
+
+    Tim_FreeRun(Config->Timer, Config->Prescaler);
+    Tim_InputChannel(Descriptor->Registers, Config->Channel, 1, Config->Filter, Config->Edge);
+    Descriptor->Registers->DIER = 1UL << (TIM_DIER_CC1DE + Config->Channel);
+
+    //---------------------------------------------------------//
+
+    // In direct mode the memory width follows the peripheral width
+    Dma_Config_t Dma = {0};
+    Dma.Controller = Request->Controller;
+    Dma.Stream = Request->Stream;
+    Dma.Channel = Request->Channel;
+    Dma.Direction = Dma_Peripheral_To_Memory;
+    Dma.Peripheral_Size = Descriptor->Wide ? Dma_Word : Dma_Half_Word;
+    Dma.Memory_Size = Dma.Peripheral_Size;
+    Dma.Memory_Increment = 1;
+    Dma.Circular = Config->Circular;
+    Dma.Priority = Dma_Priority_High;
+    Dma.Callback = Config->Callback;
+    Dma.Context = Config->Context;
+    Mcal_Dma_Init(&Dma);
+
+    return 1;
+    }
+
+/**
+ * @brief  Arms the DMA stream and starts the counter.
+ * @param  Config: Capture configuration.
+ * @return None
+ */
+void Mcal_Tim_Capture_Start(const Tim_Capture_Config_t *Config)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Config->Timer];
+    const Tim_Dma_t *Request = &Descriptor->Channel_Dma[Config->Channel];
+
+    Mcal_Dma_Start(Request->Controller, Request->Stream,
+	    &Descriptor->Registers->CCR[Config->Channel], Config->Buffer, Config->Count);
+    Set(Descriptor->Registers->CR1, TIM_CR1_CEN, 1);
+    }
+
+/**
+ * @brief  Stops the counter and the DMA stream.
+ * @param  Config: Capture configuration.
+ * @return None
+ */
+void Mcal_Tim_Capture_Stop(const Tim_Capture_Config_t *Config)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Config->Timer];
+    const Tim_Dma_t *Request = &Descriptor->Channel_Dma[Config->Channel];
+
+    Clear(Descriptor->Registers->CR1, TIM_CR1_CEN, 1);
+    Mcal_Dma_Stop(Request->Controller, Request->Stream);
+    }
+
+/**
+ * @brief  Returns the index of the next timestamp slot.
+ * @param  Config: Capture configuration.
+ * @return Write index in Buffer.
+ */
+uint16_t Mcal_Tim_Capture_Head(const Tim_Capture_Config_t *Config)
+    {
+    const Tim_Dma_t *Request = &Tim_Descriptors[Config->Timer].Channel_Dma[Config->Channel];
+    uint16_t Head = (uint16_t) (Config->Count - Mcal_Dma_Remaining(Request->Controller, Request->Stream));
+
+    return (Head >= Config->Count) ? 0 : Head;
+    }
+
+/**
+ * @brief  Returns the ticks between the two most recent timestamps.
+ * @param  Config: Capture configuration.
+ * @return Period in timer ticks.
+ */
+uint32_t Mcal_Tim_Capture_Period(const Tim_Capture_Config_t *Config)
+    {
+    uint16_t Head = Mcal_Tim_Capture_Head(Config);
+    uint16_t Newest = (uint16_t) ((Head + Config->Count - 1) % Config->Count);
+    uint16_t Previous = (uint16_t) ((Head + Config->Count - 2) % Config->Count);
+
+    // Unsigned subtraction at the counter width handles a counter wrap between edges
+    if (Tim_Descriptors[Config->Timer].Wide)
+	{
+	const uint32_t *Stamps = Config->Buffer;
+	return Stamps[Newest] - Stamps[Previous];
+	}
+
+    const uint16_t *Stamps = Config->Buffer;
+    return (uint16_t) (Stamps[Newest] - Stamps[Previous]);
+    }
+
+/**
+ * @brief  Configures PWM-input mode on channel 1 (period on CCR1, high time on CCR2).
+ * @param  Timer: Timer.
+ * @param  Prescaler: Counter prescaler.
+ * @param  Filter: Input filter.
+ * @return 1 on success, 0 if the timer has no slave-mode controller.
+ */
+uint8_t Mcal_Tim_PwmInput_Init(Tim_Id_t Timer, uint16_t Prescaler, uint8_t Filter)
+    {
+    TIM_TypeDef *TIMx = Tim_Descriptors[Timer].Registers;
+
+    if (!(Tim_Descriptors[Timer].Capabilities & TIM_CAP_SLAVE))
+	{
+	return 0;
+	}
+
+    Tim_FreeRun(Timer, Prescaler);
+
+    // Both channels watch TI1: CH1 on the rising edge, CH2 on the falling edge
+    Tim_InputChannel(TIMx, Tim_Channel_1, 1, Filter, Tim_Rising);
+    Tim_InputChannel(TIMx, Tim_Channel_2, 2, Filter, Tim_Falling);
+
+    // Slave reset mode triggered by TI1FP1 restarts the count on every rising edge
+    TIMx->SMCR = (0b101UL << TIM_SMCR_TS) | (0b100UL << TIM_SMCR_SMS);
+
+    Set(TIMx->CR1, TIM_CR1_CEN, 1);
+    return 1;
+    }
+
+/**
+ * @brief  Reads the last measured cycle.
+ * @param  Timer: Timer.
+ * @param  Period: Period in ticks.
+ * @param  High: High time in ticks.
+ * @return None
+ */
+void Mcal_Tim_PwmInput_Read(Tim_Id_t Timer, uint32_t *Period, uint32_t *High)
+    {
+    TIM_TypeDef *TIMx = Tim_Descriptors[Timer].Registers;
+
+    *Period = TIMx->CCR[Tim_Channel_1];
+    *High = TIMx->CCR[Tim_Channel_2];
+    }
+
+/**
+ * @brief  Configures encoder mode 3 (count on both edges of both inputs).
+ * @param  Timer: Timer.
+ * @param  Filter: Input filter.
+ * @return 1 on success, 0 if the timer has no encoder interface.
+ */
+uint8_t Mcal_Tim_Encoder_Init(Tim_Id_t Timer, uint8_t Filter)
+    {
+    TIM_TypeDef *TIMx = Tim_Descriptors[Timer].Registers;
+
+    if (!(Tim_Descriptors[Timer].Capabilities & TIM_CAP_ENCODER))
+	{
+	return 0;
+	}
+
+    Tim_FreeRun(Timer, 0);
+    Tim_InputChannel(TIMx, Tim_Channel_1, 1, Filter, Tim_Rising);
+    Tim_InputChannel(TIMx, Tim_Channel_2, 1, Filter, Tim_Rising);
+    TIMx->SMCR = 0b011UL << TIM_SMCR_SMS;
+    TIMx->CNT = 0;
+
+    Set(TIMx->CR1, TIM_CR1_CEN, 1);
+    return 1;
+    }
+
+/**
+ * @brief  Returns the encoder position.
+ * @param  Timer: Timer.
+ * @return Signed position in counts.
+ */
+int32_t Mcal_Tim_Encoder_Position(Tim_Id_t Timer)
+    {
+    const Tim_Descriptor_t *Descriptor = &Tim_Descriptors[Timer];
+
+    if (Descriptor->Wide)
+	{
+	return (int32_t) Descriptor->Registers->CNT;
+	}
+    return (int16_t) Descriptor->Registers->CNT;
+    }
+
+/**
+ * @brief  Resets the encoder position to zero.
+ * @param  Timer: Timer.
+ * @return None
+ */
+void Mcal_Tim_Encoder_Reset(Tim_Id_t Timer)
+    {
+    Tim_Descriptors[Timer].Registers->CNT = 0;
+    }
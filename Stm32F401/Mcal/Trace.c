@@ -0,0 +1,59 @@
+/*
+ * Trace.c
+ *
+ *  Created on: Sep 2, 2024
+ *      Author: xcite
+ */
+
+#include "../Inc/Trace.h"
+#include "../Lib/Inc/Atomic.h"
+
+#if TRACE_ENABLE
+
+Trace_Buffer_t Trace_Buffer;
+
+/**
+ * @brief  Enables the DWT cycle counter and resets the trace buffer.
+ * @return None
+ */
+void Mcal_Trace_Init(void)
+    {
+    // Power the trace units and start the cycle counter
+    Set(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA, 1);
+    DWT->CYCCNT = 0;
+    Set(DWT->CTRL, DWT_CTRL_CYCCNTENA, 1);
+
+    //---------------------------------------------------------//
+
+    // Reset the buffer; the magic word is written last so a dump taken
+    // mid-initialisation is not mistaken for a valid buffer
+    Trace_Buffer.Head = 0;
+    Trace_Buffer.Capacity = TRACE_BUFFER_SIZE;
+    Trace_Buffer.Magic = TRACE_MAGIC;
+    }
+
+/**
+ * @brief  Records a single event into the ring buffer.
+ * @param  Id: Event ID with optional TRACE_FLAG_* bits.
+ * @param  Arg: Event argument.
+ * @return None
+ */
+void Mcal_Trace_Event(uint16_t Id, uint32_t Arg)
+    {
+    // Sample the timestamp first so it is as close to the trace point as possible
+    uint32_t Timestamp = DWT->CYCCNT;
+    // Lock-free slot reservation: an interrupt recording in between just takes the next slot
+    uint32_t Index = Atomic_FetchAdd(&Trace_Buffer.Head, 1);
+    Trace_Record_t *Record = &Trace_Buffer.Records[Index & (TRACE_BUFFER_SIZE - 1)];
+
+    Record->Timestamp = Timestamp;
+    Record->Arg = Arg;
+    Record->Id = Id;
+
+    // The decoder takes a matching Sequence as proof the record is complete,
+    // so it must reach memory after every other field
+    Atomic_Barrier();
+    Record->Sequence = (uint16_t) Index;
+    }
+
+#endif /* TRACE_ENABLE */
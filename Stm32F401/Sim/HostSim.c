@@ -0,0 +1,41 @@
+/*
+ * HostSim.c
+ *
+ *  Created on: Sep 9, 2024
+ *      Author: xcite
+ */
+
+/*
+ * Host register simulator: backs the peripheral address space with RAM so
+ * the MCAL/HAL sources build and run on a PC. Only compiled into host
+ * builds (-DHOST_SIM); the firmware configurations never list this folder.
+ */
+
+#ifdef HOST_SIM
+
+#include "../Inc/stm32f401xc.h"
+#include <time.h>
+
+/**
+ * @brief Register image for 0x40000000 - 0x40027FFF (APB1, APB2, AHB1).
+ */
+uint32_t HostSim_Peripherals[0x28000 / 4];
+
+/**
+ * @brief Register image for 0xE0000000 - 0xE000FFFF (ITM, DWT, SCS).
+ */
+uint32_t HostSim_Private_Peripherals[0x10000 / 4];
+
+/**
+ * @brief  Host stand-in for DWT->CYCCNT.
+ * @return Monotonic host time in nanoseconds, truncated to 32 bits.
+ */
+uint32_t HostSim_Cycles(void)
+    {
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint32_t) ((uint64_t) Now.tv_sec * 1000000000ULL + (uint64_t) Now.tv_nsec);
+    }
+
+#endif /* HOST_SIM */
@@ -0,0 +1,240 @@
+/*
+ * Ring_Stress.c
+ *
+ *  Created on: Oct 21, 2024
+ *      Author: xcite
+ */
+
+/*
+ * Host stress test of the lock-free rings in Lib/Ring.c: producer threads
+ * hammer small rings so they wrap and fill constantly, and the consumer
+ * checks that every element arrives exactly once, untorn, and in order per
+ * producer. Exits non-zero on the first failure.
+ *
+ * Host build (Atomic.h maps onto the __atomic builtins under HOST_SIM):
+ *   gcc -O2 -fshort-enums -DHOST_SIM -pthread Sim/Ring_Stress.c Lib/Ring.c \
+ *       -o ring_stress
+ */
+
+#ifdef HOST_SIM
+
+#include "../Lib/Inc/Ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+/**
+ * @brief Test dimensions: tiny rings and many elements keep the full/empty
+ * and wrap paths busy.
+ */
+#define STRESS_ELEMENTS   1000000UL
+#define STRESS_PRODUCERS  4
+#define STRESS_SPSC_SIZE  16
+#define STRESS_MPSC_SIZE  8
+
+/**
+ * @brief Test element; Check detects a torn copy.
+ */
+typedef struct
+{
+    uint32_t Producer; /*!< Producer number */
+    uint32_t Sequence; /*!< Per-producer sequence number */
+    uint32_t Check; /*!< ~(Producer ^ Sequence) */
+} Stress_Element_t;
+
+static uint8_t Spsc_Storage[STRESS_SPSC_SIZE * sizeof(Stress_Element_t)];
+static Ring_Spsc_t Spsc;
+
+static uint32_t Mpsc_Storage[RING_MPSC_STORAGE_WORDS(STRESS_MPSC_SIZE, sizeof(Stress_Element_t))];
+static Ring_Mpsc_t Mpsc;
+
+/**
+ * @brief  Builds the element a producer sends at a sequence number.
+ * @param  Producer: Producer number.
+ * @param  Sequence: Sequence number.
+ * @return Element.
+ */
+static Stress_Element_t Stress_Make(uint32_t Producer, uint32_t Sequence)
+    {
+    Stress_Element_t Element = {Producer, Sequence, ~(Producer ^ Sequence)};
+
+    return Element;
+    }
+
+/**
+ * @brief  SPSC producer thread.
+ * @param  Argument: Unused.
+ * @return NULL
+ */
+static void *Stress_SpscProducer(void *Argument)
+    {
+    (void) Argument;
+
+    for (uint32_t i = 0; i < STRESS_ELEMENTS; i++)
+	{
+	Stress_Element_t Element = Stress_Make(0, i);
+
+	while (!Ring_Spsc_Push(&Spsc, &Element))
+	    {
+	    sched_yield();
+	    }
+	}
+    return NULL;
+    }
+
+/**
+ * @brief  MPSC producer thread.
+ * @param  Argument: Producer number.
+ * @return NULL
+ */
+static void *Stress_MpscProducer(void *Argument)
+    {
+    uint32_t Producer = (uint32_t) (uintptr_t) Argument;
+
+    for (uint32_t i = 0; i < STRESS_ELEMENTS; i++)
+	{
+	Stress_Element_t Element = Stress_Make(Producer, i);
+
+	while (!Ring_Mpsc_Push(&Mpsc, &Element))
+	    {
+	    sched_yield();
+	    }
+	}
+    return NULL;
+    }
+
+/**
+ * @brief  Checks one received element against the next one expected.
+ * @param  Element: Received element.
+ * @param  Expected: Next sequence number of every producer.
+ * @param  Producers: Number of producers.
+ * @return 1 if valid, 0 otherwise.
+ */
+static uint8_t Stress_Check(const Stress_Element_t *Element, uint32_t *Expected, uint32_t Producers)
+    {
+    if ((Element->Producer >= Producers) || (Element->Check != ~(Element->Producer ^ Element->Sequence)))
+	{
+	printf("  torn element: producer %u sequence %u check %08X\n", Element->Producer,
+		Element->Sequence, Element->Check);
+	return 0;
+	}
+
+    // Exactly the next sequence: anything else is a loss, a duplicate or a reorder
+    if (Element->Sequence != Expected[Element->Producer])
+	{
+	printf("  producer %u: expected %u, got %u\n", Element->Producer,
+		Expected[Element->Producer], Element->Sequence);
+	return 0;
+	}
+    Expected[Element->Producer]++;
+    return 1;
+    }
+
+/**
+ * @brief  Runs the SPSC test.
+ * @return 1 on success, 0 on failure.
+ */
+static uint8_t Stress_Spsc(void)
+    {
+    pthread_t Thread;
+    uint32_t Expected = 0;
+    Stress_Element_t Element;
+    uint8_t Passed = 1;
+
+    Ring_Spsc_Init(&Spsc, Spsc_Storage, STRESS_SPSC_SIZE, sizeof(Stress_Element_t));
+    pthread_create(&Thread, NULL, Stress_SpscProducer, NULL);
+
+    while (Passed && (Expected < STRESS_ELEMENTS))
+	{
+	if (Ring_Spsc_Pop(&Spsc, &Element))
+	    {
+	    Passed = Stress_Check(&Element, &Expected, 1);
+	    }
+	else
+	    {
+	    sched_yield();
+	    }
+	}
+
+    pthread_join(Thread, NULL);
+    if (Passed && (Ring_Spsc_Pop(&Spsc, &Element) || Ring_Spsc_Count(&Spsc)))
+	{
+	printf("  ring not empty after the last element\n");
+	Passed = 0;
+	}
+    return Passed;
+    }
+
+/**
+ * @brief  Runs the MPSC test.
+ * @return 1 on success, 0 on failure.
+ */
+static uint8_t Stress_Mpsc(void)
+    {
+    pthread_t Threads[STRESS_PRODUCERS];
+    uint32_t Expected[STRESS_PRODUCERS] = {0};
+    uint64_t Received = 0;
+    Stress_Element_t Element;
+    uint8_t Passed = 1;
+
+    Ring_Mpsc_Init(&Mpsc, Mpsc_Storage, STRESS_MPSC_SIZE, sizeof(Stress_Element_t));
+    for (uint32_t i = 0; i < STRESS_PRODUCERS; i++)
+	{
+	pthread_create(&Threads[i], NULL, Stress_MpscProducer, (void *) (uintptr_t) i);
+	}
+
+    while (Passed && (Received < (uint64_t) STRESS_ELEMENTS * STRESS_PRODUCERS))
+	{
+	if (Ring_Mpsc_Pop(&Mpsc, &Element))
+	    {
+	    Passed = Stress_Check(&Element, Expected, STRESS_PRODUCERS);
+	    Received++;
+	    }
+	else
+	    {
+	    sched_yield();
+	    }
+	}
+
+    // On failure the producers may be blocked on a full ring; stop here
+    if (!Passed)
+	{
+	return 0;
+	}
+    for (uint32_t i = 0; i < STRESS_PRODUCERS; i++)
+	{
+	pthread_join(Threads[i], NULL);
+	}
+    if (Ring_Mpsc_Pop(&Mpsc, &Element))
+	{
+	printf("  ring not empty after the last element\n");
+	return 0;
+	}
+    return 1;
+    }
+
+int main(void)
+    {
+    uint8_t Passed = 1;
+    uint8_t Result;
+
+    // Capacities must be powers of two
+    Result = !Ring_Spsc_Init(&Spsc, Spsc_Storage, 12, sizeof(Stress_Element_t))
+	    && !Ring_Mpsc_Init(&Mpsc, Mpsc_Storage, 0, sizeof(Stress_Element_t));
+    printf("%-6s init rejects bad capacities\n", Result ? "PASS" : "FAIL");
+    Passed &= Result;
+
+    Result = Stress_Spsc();
+    printf("%-6s SPSC, 1 producer x %lu elements, capacity %u\n", Result ? "PASS" : "FAIL",
+	    STRESS_ELEMENTS, STRESS_SPSC_SIZE);
+    Passed &= Result;
+
+    Result = Stress_Mpsc();
+    printf("%-6s MPSC, %u producers x %lu elements, capacity %u\n", Result ? "PASS" : "FAIL",
+	    STRESS_PRODUCERS, STRESS_ELEMENTS, STRESS_MPSC_SIZE);
+    Passed &= Result;
+
+    return Passed ? 0 : 1;
+    }
+
+#endif /* HOST_SIM */
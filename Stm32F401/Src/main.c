@@ -1,6 +1,7 @@
 
 
 #include "../HAL/Inc/Lcd.h"
+#include "../Inc/Trace.h"
 
 void delay_ms(uint32_t ms) {
     volatile uint32_t count = ms * (16000 / 5); // Adjusted for 16 MHz clock
@@ -9,7 +10,7 @@ void delay_ms(uint32_t ms) {
     }
 }
 int main(void) {
-    RCC_GPIOA_Enable();
+    TRACE_INIT();
     LCD_PinConfig lcd_config = {
         .port = GPIOA,
         .rs = PIN_0,
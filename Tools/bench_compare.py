@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""
+bench_compare.py
+
+Compares two benchmark reports produced by the Benchmark build configuration
+(Stm32F401/Bench) and prints the change in median cost per case.
+
+Usage:
+    python3 bench_compare.py baseline.csv candidate.csv
+"""
+
+import argparse
+import csv
+import sys
+
+
+def load_report(path):
+    """Returns (build description lines, {case: row}) from a CSV report."""
+    info = []
+    rows = {}
+    with open(path, "r") as report:
+        lines = []
+        for line in report:
+            if line.startswith("#"):
+                info.append(line[1:].strip())
+            elif line.strip():
+                lines.append(line)
+    for row in csv.DictReader(lines):
+        rows[row["case"]] = {key: int(value) for key, value in row.items() if key != "case"}
+    return info, rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark reports.")
+    parser.add_argument("baseline", help="report of the reference build")
+    parser.add_argument("candidate", help="report of the build under test")
+    args = parser.parse_args()
+
+    base_info, base = load_report(args.baseline)
+    new_info, new = load_report(args.candidate)
+
+    for label, info in (("baseline", base_info), ("candidate", new_info)):
+        print("%-10s %s" % (label + ":", " ".join(info) or "(no build info)"))
+    if base_info and new_info and base_info[0].split()[0] != new_info[0].split()[0]:
+        print("warning: reports use different units", file=sys.stderr)
+    print()
+
+    print("%-20s %12s %12s %9s" % ("case", "baseline", "candidate", "change"))
+    for case in list(base) + [case for case in new if case not in base]:
+        if case not in base or case not in new:
+            print("%-20s %12s %12s %9s" % (
+                case,
+                base[case]["median"] if case in base else "-",
+                new[case]["median"] if case in new else "-",
+                "n/a"))
+            continue
+        before = base[case]["median"]
+        after = new[case]["median"]
+        change = "%+.1f%%" % ((after - before) * 100.0 / before) if before else "n/a"
+        print("%-20s %12u %12u %9s" % (case, before, after, change))
+
+
+if __name__ == "__main__":
+    main()
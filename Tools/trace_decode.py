@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+trace_decode.py
+
+Decodes the binary trace ring buffer (Trace_Buffer, see Stm32F401/Inc/Trace.h)
+from a raw RAM dump into a timeline and per-function latency histograms.
+
+Taking a dump, e.g. with GDB (the address is printed by `p &Trace_Buffer`):
+    dump binary memory trace.bin 0x20000000 0x20010000
+
+Usage:
+    python3 trace_decode.py trace.bin [--clock 16000000] [--no-timeline]
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+TRACE_MAGIC = 0x45435254
+TRACE_FLAG_EXIT = 0x8000
+TRACE_FLAG_MARK = 0x4000
+TRACE_ID_MASK = 0x3FFF
+
+# Largest backwards step between consecutive records that is taken as an
+# ISR reordering (timestamp sampled before the slot reservation) rather than
+# a forward jump across a long idle gap
+REORDER_WINDOW = 4096
+
+HEADER_FORMAT = "<IIII"  # Magic, Capacity, Head, Reserved
+RECORD_FORMAT = "<IHHI"  # Timestamp, Id, Sequence, Arg
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              "..", "Stm32F401", "Inc", "Trace.h")
+
+
+def load_event_names(header_path):
+    """Reads the Trace_Id_t enumerators from Trace.h so names never drift."""
+    names = {}
+    try:
+        with open(header_path, "r") as header:
+            text = header.read()
+    except OSError:
+        return names
+
+    body = re.search(r"typedef enum\s*{(.*?)}\s*Trace_Id_t;", text, re.S)
+    if not body:
+        return names
+
+    value = -1
+    for line in body.group(1).splitlines():
+        match = re.match(r"\s*(TRACE_ID_\w+)\s*(?:=\s*(0x[0-9A-Fa-f]+|\d+))?", line)
+        if not match:
+            continue
+        value = int(match.group(2), 0) if match.group(2) else value + 1
+        names[value] = match.group(1)[len("TRACE_ID_"):]
+    return names
+
+
+def find_buffer(data, offset):
+    """Returns the offset of the trace buffer, searching for the magic word if needed."""
+    if offset is not None:
+        return offset
+    magic = struct.pack("<I", TRACE_MAGIC)
+    position = data.find(magic)
+    while position != -1:
+        if position % 4 == 0:
+            return position
+        position = data.find(magic, position + 1)
+    sys.exit("trace_decode: no trace buffer (magic 0x%08X) found in dump" % TRACE_MAGIC)
+
+
+def read_records(data, offset):
+    """Returns the surviving records, oldest first, with unwrapped timestamps."""
+    magic, capacity, head, _ = struct.unpack_from(HEADER_FORMAT, data, offset)
+    if magic != TRACE_MAGIC:
+        sys.exit("trace_decode: bad magic 0x%08X at offset 0x%X" % (magic, offset))
+    if capacity == 0 or capacity & (capacity - 1):
+        sys.exit("trace_decode: bad capacity %u" % capacity)
+
+    base = offset + struct.calcsize(HEADER_FORMAT)
+    size = struct.calcsize(RECORD_FORMAT)
+    if base + capacity * size > len(data):
+        sys.exit("trace_decode: dump ends inside the trace buffer")
+
+    count = min(head, capacity)
+    records = []
+    torn = 0
+    previous = None
+    now = 0
+    for index in range(head - count, head):
+        timestamp, event, sequence, arg = struct.unpack_from(
+            RECORD_FORMAT, data, base + (index & (capacity - 1)) * size)
+        if sequence != index & 0xFFFF:
+            # Slot reserved but not yet written when the dump was taken
+            torn += 1
+            continue
+        if previous is not None:
+            # Forward modulo 2^32 (CYCCNT wrap, idle gaps), except for the small
+            # backwards steps an ISR preempting a trace point produces
+            delta = (timestamp - previous) & 0xFFFFFFFF
+            now += delta - (1 << 32) if delta > 0xFFFFFFFF - REORDER_WINDOW else delta
+        previous = timestamp
+        records.append((index, now, event, arg))
+
+    return head, capacity, torn, records
+
+
+def describe(names, event):
+    name = names.get(event & TRACE_ID_MASK, "0x%04X" % (event & TRACE_ID_MASK))
+    if event & TRACE_FLAG_EXIT:
+        return name, "EXIT"
+    if event & TRACE_FLAG_MARK:
+        return name, "MARK"
+    return name, "ENTER"
+
+
+def print_timeline(names, records, clock):
+    print("%10s %12s %10s  %s" % ("index", "time [us]", "dt [cyc]", "event"))
+    depth = 0
+    last = records[0][1] if records else 0
+    for index, now, event, arg in records:
+        name, kind = describe(names, event)
+        if kind == "EXIT":
+            depth = max(depth - 1, 0)
+        print("%10u %12.3f %10d  %s%-5s %s (0x%08X)" % (
+            index, now * 1e6 / clock, now - last, "  " * depth, kind, name, arg))
+        if kind == "ENTER":
+            depth += 1
+        last = now
+
+
+def collect_latencies(records):
+    """Pairs ENTER/EXIT events per ID; a stack per ID copes with ISR re-entry."""
+    open_calls = {}
+    latencies = {}
+    for _, now, event, _ in records:
+        ident = event & TRACE_ID_MASK
+        if event & TRACE_FLAG_MARK:
+            continue
+        if event & TRACE_FLAG_EXIT:
+            stack = open_calls.get(ident)
+            if stack:
+                # A reordered pair can come out slightly negative
+                latencies.setdefault(ident, []).append(max(now - stack.pop(), 0))
+        else:
+            open_calls.setdefault(ident, []).append(now)
+    return latencies
+
+
+def print_histograms(names, latencies, clock, width):
+    for ident in sorted(latencies):
+        samples = sorted(latencies[ident])
+        name = names.get(ident, "0x%04X" % ident)
+        median = samples[len(samples) // 2]
+        print()
+        print("%s: n=%u min=%u median=%u max=%u cycles (median %.3f us)" % (
+            name, len(samples), samples[0], median, samples[-1], median * 1e6 / clock))
+
+        # Power-of-two buckets keep the table short across LCD-delay ranges
+        buckets = {}
+        for sample in samples:
+            bucket = max(sample, 1).bit_length() - 1
+            buckets[bucket] = buckets.get(bucket, 0) + 1
+        peak = max(buckets.values())
+        for bucket in range(min(buckets), max(buckets) + 1):
+            hits = buckets.get(bucket, 0)
+            bar = "#" * ((hits * width + peak - 1) // peak)
+            print("  %10u - %10u | %6u %s" % (1 << bucket, (2 << bucket) - 1, hits, bar))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a Trace_Buffer RAM dump.")
+    parser.add_argument("dump", help="raw binary RAM dump containing Trace_Buffer")
+    parser.add_argument("--offset", type=lambda text: int(text, 0),
+                        help="byte offset of Trace_Buffer in the dump (default: search)")
+    parser.add_argument("--clock", type=float, default=16e6,
+                        help="core clock in Hz used to convert cycles (default: 16e6)")
+    parser.add_argument("--header", default=DEFAULT_HEADER,
+                        help="path to Trace.h for event names")
+    parser.add_argument("--width", type=int, default=50, help="histogram bar width")
+    parser.add_argument("--no-timeline", action="store_true", help="skip the timeline")
+    parser.add_argument("--no-histogram", action="store_true", help="skip the histograms")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as dump:
+        data = dump.read()
+
+    names = load_event_names(args.header)
+    offset = find_buffer(data, args.offset)
+    head, capacity, torn, records = read_records(data, offset)
+
+    print("Trace buffer at offset 0x%X: %u events recorded, %u kept, %u lost, %u torn" % (
+        offset, head, len(records), max(head - capacity, 0), torn))
+
+    if not args.no_timeline:
+        print()
+        print_timeline(names, records, args.clock)
+    if not args.no_histogram:
+        print_histograms(names, collect_latencies(records), args.clock, args.width)
+
+
+if __name__ == "__main__":
+    main()